@@ -1,11 +1,11 @@
-// TODO to remove
-
-
-
-
-
-
-
-
-
-
+// TODO to remove
+
+
+
+
+
+
+
+
+
+
@@ -0,0 +1,431 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "AssetPack.h"
+#include "TextureRegistry.h"
+#include "WorldMap.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string.h>
+#include <unordered_map>
+
+
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+uint64_t alignUp(uint64_t offset) noexcept
+{
+    return (offset + AssetPack::ALIGNMENT - 1) & ~uint64_t(AssetPack::ALIGNMENT - 1);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+// Halve an image averaging 2x2 pixel blocks, channel by channel (odd
+// edges repeat their last row or column)
+void halveImage(
+    const DWORD* src, uint32_t srcDx, uint32_t srcDy,
+    DWORD* dst, uint32_t dx, uint32_t dy) noexcept
+{
+    for (uint32_t y = 0; y < dy; ++y) {
+        const DWORD* row0 = src + size_t(std::min(2 * y, srcDy - 1)) * srcDx;
+        const DWORD* row1 = src + size_t(std::min(2 * y + 1, srcDy - 1)) * srcDx;
+
+        for (uint32_t x = 0; x < dx; ++x) {
+            const uint32_t x0 = std::min(2 * x, srcDx - 1);
+            const uint32_t x1 = std::min(2 * x + 1, srcDx - 1);
+            const DWORD p[4] = { row0[x0], row0[x1], row1[x0], row1[x1] };
+
+            DWORD pixel = 0;
+
+            for (int shift = 0; shift < 32; shift += 8) {
+                uint32_t sum = 2;
+
+                for (int i = 0; i < 4; ++i) {
+                    sum += (p[i] >> shift) & 0xff;
+                }
+
+                pixel |= DWORD((sum >> 2) << shift);
+            }
+
+            dst[size_t(y) * dx + x] = pixel;
+        }
+    }
+}
+
+} // namespace
+
+
+/* -------------------------------------------------------------------------- */
+
+uint64_t AssetPack::getLevelLayout(
+    uint32_t dx,
+    uint32_t dy,
+    uint32_t levels,
+    uint64_t* offsets,
+    uint32_t* levelDx,
+    uint32_t* levelDy) noexcept
+{
+    uint64_t offset = 0;
+
+    for (uint32_t i = 0; i < levels; ++i) {
+        offset = alignUp(offset);
+
+        offsets[i] = offset;
+        levelDx[i] = dx;
+        levelDy[i] = dy;
+
+        offset += uint64_t(dx) * dy * sizeof(DWORD);
+
+        dx = std::max(dx / 2, 1u);
+        dy = std::max(dy / 2, 1u);
+    }
+
+    return offset;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool AssetPack::setError(const std::string& what)
+{
+    m_lastError = what;
+    close();
+
+    return false;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool AssetPack::open(const std::string& fileName)
+{
+    close();
+    m_lastError.clear();
+
+    if (!m_file.open(fileName)) {
+        return setError("cannot open " + fileName);
+    }
+
+    const char* data = m_file.data();
+    const uint64_t size = m_file.size();
+
+    Header hdr;
+
+    if (size < sizeof(hdr)) {
+        return setError("invalid pack header");
+    }
+
+    memcpy(&hdr, data, sizeof(hdr));
+
+    if (memcmp(hdr.magic, magic(), sizeof(hdr.magic)) != 0 ||
+        hdr.alignment != ALIGNMENT)
+    {
+        return setError("invalid pack header");
+    }
+
+    if ((size - sizeof(hdr)) / sizeof(TextureEntry) < hdr.textures) {
+        return setError("truncated texture table");
+    }
+
+    if (hdr.mapOffset % ALIGNMENT != 0) {
+        return setError("invalid map offset");
+    }
+
+    if (hdr.mapOffset > size || hdr.mapSize > size - hdr.mapOffset) {
+        return setError("truncated map");
+    }
+
+    const char* entries = data + sizeof(hdr);
+
+    m_textures.resize(hdr.textures);
+
+    for (uint32_t t = 0; t < hdr.textures; ++t) {
+        TextureEntry entry;
+
+        memcpy(&entry, entries + t * sizeof(entry), sizeof(entry));
+
+        // The table is searched by key (see getTexture): keys must be
+        // sorted, with no duplicates
+        if (entry.panelKey > 0xff ||
+            (t > 0 && int(entry.panelKey) <= m_textures[t - 1].panelKey) ||
+            entry.dx < 1 || entry.dx > MAX_TEXTURE_SIZE ||
+            entry.dy < 1 || entry.dy > MAX_TEXTURE_SIZE ||
+            entry.levels < 1 || entry.levels > MAX_LEVELS ||
+            entry.offset % ALIGNMENT != 0)
+        {
+            return setError("invalid texture " + std::to_string(t));
+        }
+
+        uint64_t offsets[MAX_LEVELS];
+        uint32_t levelDx[MAX_LEVELS];
+        uint32_t levelDy[MAX_LEVELS];
+
+        const uint64_t texSize = getLevelLayout(
+            entry.dx, entry.dy, entry.levels, offsets, levelDx, levelDy);
+
+        if (entry.offset > size || texSize > size - entry.offset ||
+            texSize > entry.size)
+        {
+            return setError("truncated texture " + std::to_string(t));
+        }
+
+        Texture& texture = m_textures[t];
+
+        texture.panelKey = int(entry.panelKey);
+        texture.levels.resize(entry.levels);
+
+        for (uint32_t i = 0; i < entry.levels; ++i) {
+            const DWORD* pixels =
+                (const DWORD*)(data + entry.offset + offsets[i]);
+
+            texture.levels[i].reset(new BitmapBuffer);
+            texture.levels[i]->attach(pixels, int(levelDx[i]), int(levelDy[i]));
+        }
+    }
+
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void AssetPack::close() noexcept
+{
+    m_textures.clear();
+    m_file.close();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool AssetPack::loadMap(WorldMap& wMap) const
+{
+    Header hdr;
+
+    if (!isOpen()) {
+        return false;
+    }
+
+    memcpy(&hdr, m_file.data(), sizeof(hdr));
+
+    return wMap.load(m_file.data() + hdr.mapOffset, size_t(hdr.mapSize));
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+const BitmapBuffer* AssetPack::getTexture(int panelKey, int level) const noexcept
+{
+    auto it = std::lower_bound(m_textures.begin(), m_textures.end(), panelKey,
+        [](const Texture& texture, int key) {
+            return texture.panelKey < key;
+        });
+
+    if (it == m_textures.end() || it->panelKey != panelKey ||
+        level < 0 || size_t(level) >= it->levels.size())
+    {
+        return nullptr;
+    }
+
+    return it->levels[level].get();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void AssetPack::applyTo(WorldMap& wMap) const noexcept
+{
+    for (const auto & texture : m_textures) {
+        wMap.applyTextureToPanel(texture.panelKey, texture.levels[0].get());
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool AssetPack::write(
+    const std::string& fileName,
+    const WorldMap& wMap,
+    const std::map<int, const BitmapBuffer*>& textures,
+    int levels,
+    std::string& error)
+{
+    std::ostringstream mapStream(std::ios::out | std::ios::binary);
+
+    if (!wMap.saveBinary(mapStream)) {
+        error = "cannot compile the map";
+        return false;
+    }
+
+    const std::string map = mapStream.str();
+
+    Header hdr = { { 0 } };
+
+    memcpy(hdr.magic, magic(), sizeof(hdr.magic));
+    hdr.textures = uint32_t(textures.size());
+    hdr.alignment = ALIGNMENT;
+    hdr.mapOffset = alignUp(sizeof(hdr) + textures.size() * sizeof(TextureEntry));
+    hdr.mapSize = map.size();
+
+    // Place the textures after the map; the pixels of identical textures
+    // are stored once, and their entries refer to the same offset
+    std::vector<TextureEntry> entries;
+    std::vector<bool> shared;
+    std::unordered_multimap<uint64_t, size_t> hashes;
+    uint64_t offset = hdr.mapOffset + hdr.mapSize;
+
+    for (const auto & item : textures) {
+        const BitmapBuffer* image = item.second;
+
+        if (item.first < 0 || item.first > 0xff || !image ||
+            image->getDx() < 1 || image->getDx() > MAX_TEXTURE_SIZE ||
+            image->getDy() < 1 || image->getDy() > MAX_TEXTURE_SIZE)
+        {
+            error = "invalid texture for key " + std::to_string(item.first);
+            return false;
+        }
+
+        TextureEntry entry = { 0 };
+
+        entry.panelKey = uint32_t(item.first);
+        entry.dx = uint32_t(image->getDx());
+        entry.dy = uint32_t(image->getDy());
+
+        // Stop at the 1x1 level
+        const uint32_t maxLevels = std::max(1, std::min(levels, int(MAX_LEVELS)));
+
+        entry.levels = 1;
+
+        for (uint32_t dx = entry.dx, dy = entry.dy;
+            entry.levels < maxLevels && (dx > 1 || dy > 1);
+            dx = std::max(dx / 2, 1u), dy = std::max(dy / 2, 1u))
+        {
+            ++entry.levels;
+        }
+
+        const uint64_t hash = TextureRegistry::hash(*image);
+        auto range = hashes.equal_range(hash);
+        auto same = range.first;
+
+        for (; same != range.second; ++same) {
+            const TextureEntry& other = entries[same->second];
+
+            if (other.levels == entry.levels &&
+                TextureRegistry::equal(*textures.at(int(other.panelKey)), *image))
+            {
+                break;
+            }
+        }
+
+        if (same != range.second) {
+            entry.offset = entries[same->second].offset;
+            entry.size = entries[same->second].size;
+            shared.push_back(true);
+        }
+        else {
+            uint64_t offsets[MAX_LEVELS];
+            uint32_t levelDx[MAX_LEVELS];
+            uint32_t levelDy[MAX_LEVELS];
+
+            entry.offset = alignUp(offset);
+            entry.size = getLevelLayout(
+                entry.dx, entry.dy, entry.levels, offsets, levelDx, levelDy);
+
+            offset = entry.offset + entry.size;
+
+            hashes.emplace(hash, entries.size());
+            shared.push_back(false);
+        }
+
+        entries.push_back(entry);
+    }
+
+    std::ofstream os(fileName, std::ios::out | std::ios::binary);
+
+    if (!os.is_open()) {
+        error = "cannot create " + fileName;
+        return false;
+    }
+
+    uint64_t pos = 0;
+
+    auto writeAt = [&os, &pos](uint64_t at, const void* data, size_t size) {
+        static const char padding[ALIGNMENT] = { 0 };
+
+        for (; pos < at; pos += std::min(at - pos, uint64_t(ALIGNMENT))) {
+            os.write(padding, std::streamsize(std::min(at - pos, uint64_t(ALIGNMENT))));
+        }
+
+        os.write((const char*)data, std::streamsize(size));
+        pos += size;
+    };
+
+    writeAt(0, &hdr, sizeof(hdr));
+
+    for (const auto & entry : entries) {
+        writeAt(pos, &entry, sizeof(entry));
+    }
+
+    writeAt(hdr.mapOffset, map.data(), map.size());
+
+    auto entry = entries.begin();
+    auto isShared = shared.begin();
+
+    for (const auto & item : textures) {
+        if (*isShared++) {
+            ++entry;
+            continue;
+        }
+
+        uint64_t offsets[MAX_LEVELS];
+        uint32_t levelDx[MAX_LEVELS];
+        uint32_t levelDy[MAX_LEVELS];
+
+        getLevelLayout(
+            entry->dx, entry->dy, entry->levels, offsets, levelDx, levelDy);
+
+        const BitmapBuffer* image = item.second;
+
+        writeAt(entry->offset, image->getPixels(),
+            size_t(entry->dx) * entry->dy * sizeof(DWORD));
+
+        // Each level is filtered from the previous one
+        std::vector<DWORD> level(image->getPixels(),
+            image->getPixels() + size_t(entry->dx) * entry->dy);
+
+        for (uint32_t i = 1; i < entry->levels; ++i) {
+            std::vector<DWORD> next(size_t(levelDx[i]) * levelDy[i]);
+
+            halveImage(level.data(), levelDx[i - 1], levelDy[i - 1],
+                next.data(), levelDx[i], levelDy[i]);
+
+            writeAt(entry->offset + offsets[i], next.data(),
+                next.size() * sizeof(DWORD));
+
+            level.swap(next);
+        }
+
+        ++entry;
+    }
+
+    if (!os) {
+        error = "error writing " + fileName;
+        return false;
+    }
+
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
@@ -0,0 +1,151 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __ASSETPACK_H__
+#define __ASSETPACK_H__
+
+/* -------------------------------------------------------------------------- */
+
+#include "BitmapBuffer.h"
+
+#include "./miptknzr/include/mip_mmap_file.h"
+
+#include <map>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+
+/* -------------------------------------------------------------------------- */
+
+class WorldMap;
+
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Single file holding the assets of a deployment: the compiled (binary)
+ * map and the textures, already converted to the 32 bit pixels sampled
+ * by the renderer. The file is memory-mapped and the textures refer to
+ * its content, so opening a pack neither decodes nor copies any image.
+ *
+ * Layout (little-endian): a Header, 'textures' TextureEntry records
+ * sorted by panel key, the binary map (see WorldMap::BinaryHeader) and
+ * the pixels. The pixels of a texture are stored row by row, followed by
+ * its mip levels (each of them half the size of the previous one, at
+ * least 1 pixel); the map and every level begin at a multiple of
+ * ALIGNMENT bytes from the start of the file. Identical textures are
+ * stored once: their entries refer to the same pixels
+ */
+class AssetPack
+{
+public:
+    struct Header {
+        char magic[8];
+        uint32_t textures;
+        uint32_t alignment;
+        uint64_t mapOffset;
+        uint64_t mapSize;
+    };
+
+    struct TextureEntry {
+        uint32_t panelKey;
+        uint32_t dx;
+        uint32_t dy;
+        uint32_t levels;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    enum {
+        ALIGNMENT = 64,
+        MAX_LEVELS = 16,
+        MAX_TEXTURE_SIZE = 16384
+    };
+
+    static const char* magic() noexcept {
+        return "WRCPAK01";
+    }
+
+    AssetPack() = default;
+
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    //! Map a pack file and check its content
+    //! @return false if the file cannot be opened or is not valid
+    bool open(const std::string& fileName);
+
+    void close() noexcept;
+
+    bool isOpen() const noexcept {
+        return m_file.is_open();
+    }
+
+    //! Load the map stored in the pack
+    //! @return false on error (see wMap.getLastError())
+    bool loadMap(WorldMap& wMap) const;
+
+    size_t getTextureCount() const noexcept {
+        return m_textures.size();
+    }
+
+    //! Return a mip level of the texture of a panel key (nullptr if the
+    //! pack does not contain it)
+    const BitmapBuffer* getTexture(int panelKey, int level = 0) const noexcept;
+
+    //! Set the textures to their panel keys; the pack must outlive the map
+    void applyTo(WorldMap& wMap) const noexcept;
+
+    //! Return a description of the last open() failure
+    const std::string& getLastError() const noexcept {
+        return m_lastError;
+    }
+
+    //! Return the offsets (from the first pixel of a texture) and the
+    //! sizes of its mip levels, and the total size of the texture
+    static uint64_t getLevelLayout(
+        uint32_t dx,
+        uint32_t dy,
+        uint32_t levels,
+        uint64_t* offsets,
+        uint32_t* levelDx,
+        uint32_t* levelDy) noexcept;
+
+    /**
+     * Write a pack made of a map and of the textures of the panel keys,
+     * adding to each of them up to levels-1 mip levels (box filtered)
+     * @return false on error, described by error
+     */
+    static bool write(
+        const std::string& fileName,
+        const WorldMap& wMap,
+        const std::map<int, const BitmapBuffer*>& textures,
+        int levels,
+        std::string& error);
+
+private:
+    bool setError(const std::string& what);
+
+    struct Texture {
+        int panelKey = 0;
+        std::vector<std::unique_ptr<BitmapBuffer>> levels;
+    };
+
+    mip::mmap_file_t m_file;
+    std::vector<Texture> m_textures;
+    std::string m_lastError;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif // __ASSETPACK_H__
@@ -0,0 +1,204 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "AsyncFrameSink.h"
+#include "TraceLog.h"
+
+#include <string.h>
+
+
+/* -------------------------------------------------------------------------- */
+
+AsyncFrameSink::AsyncFrameSink(FrameSink& target, int bufferCount) :
+    m_target(target),
+    m_buffers(bufferCount < MIN_BUFFERS ? MIN_BUFFERS :
+        bufferCount > MAX_BUFFERS ? MAX_BUFFERS : bufferCount)
+{
+    m_thread = std::thread([this]() { run(); });
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+AsyncFrameSink::~AsyncFrameSink()
+{
+    m_stop.store(true);
+    notify();
+    m_thread.join();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+template <typename Ready>
+void AsyncFrameSink::wait(Ready ready)
+{
+    std::unique_lock<std::mutex> lock(m_mtx);
+
+    // The waiter is registered before testing the condition, and the
+    // counters are updated before testing the waiters (see notify): the
+    // fences make sure that either the waiter sees the update or the
+    // notifier sees the waiter
+    m_waiters.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    m_cv.wait(lock, ready);
+
+    m_waiters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void AsyncFrameSink::notify()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (m_waiters.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+
+    // Taking the mutex makes sure that a thread which has just found
+    // its wait condition false is already waiting for the notification
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+    }
+
+    m_cv.notify_all();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+AsyncFrameSink::Buffer& AsyncFrameSink::waitForBuffer()
+{
+    // Only the engine thread updates m_queued
+    const size_t queued = m_queued.load(std::memory_order_relaxed);
+
+    auto isFree = [this, queued]() {
+        return queued - m_presented.load(std::memory_order_acquire) <
+            m_buffers.size();
+    };
+
+    if (!isFree()) {
+        ++m_stallCount;
+
+        TraceScope scope("present", "wait for buffer");
+        wait(isFree);
+    }
+
+    return m_buffers[queued % m_buffers.size()];
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+DWORD* AsyncFrameSink::acquire(int width, int height)
+{
+    Buffer& buffer = waitForBuffer();
+
+    buffer.pixels.resize(size_t(width) * size_t(height));
+
+    return buffer.pixels.data();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool AsyncFrameSink::present(const Frame& frame)
+{
+    Buffer& buffer = waitForBuffer();
+
+    if (frame.pixels != buffer.pixels.data()) {
+        buffer.pixels.resize(size_t(frame.width) * size_t(frame.height));
+
+        for (int y = 0; y < frame.height; ++y) {
+            memcpy(buffer.pixels.data() + size_t(y) * size_t(frame.width),
+                frame.pixels + size_t(y) * size_t(frame.pitch),
+                size_t(frame.width) * sizeof(DWORD));
+        }
+
+        buffer.frame = Frame{
+            buffer.pixels.data(), frame.width, frame.height, frame.width };
+    }
+    else {
+        buffer.frame = frame;
+    }
+
+    {
+        TraceScope scope("present", "handoff");
+
+        m_queued.fetch_add(1, std::memory_order_release);
+        notify();
+    }
+
+    return !hasFailed();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void AsyncFrameSink::flush()
+{
+    const size_t queued = m_queued.load(std::memory_order_relaxed);
+
+    wait([this, queued]() {
+        return m_presented.load(std::memory_order_acquire) == queued;
+    });
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void AsyncFrameSink::run()
+{
+    TraceLog::shared().setThreadName("presenter");
+
+    for (;;) {
+        // Only the presenter thread updates m_presented
+        const size_t presented = m_presented.load(std::memory_order_relaxed);
+
+        auto isQueued = [this, presented]() {
+            return m_queued.load(std::memory_order_acquire) != presented;
+        };
+
+        if (!isQueued()) {
+            wait([this, &isQueued]() {
+                return isQueued() || m_stop.load();
+            });
+
+            // Stopped, and all the frames queued have been presented
+            if (!isQueued()) {
+                return;
+            }
+        }
+
+        const Buffer& buffer = m_buffers[presented % m_buffers.size()];
+
+        bool ok = false;
+
+        try {
+            TraceScope scope("present", "present");
+            ok = m_target.present(buffer.frame);
+        }
+        catch (...) {
+        }
+
+        if (!ok) {
+            m_failed.store(true, std::memory_order_relaxed);
+        }
+
+        m_presented.store(presented + 1, std::memory_order_release);
+        notify();
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
@@ -0,0 +1,124 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __ASYNCFRAMESINK_H__
+#define __ASYNCFRAMESINK_H__
+
+/* -------------------------------------------------------------------------- */
+
+#include "FrameSink.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Presents the frames to another sink on a thread of its own, so that the
+ * engine renders the next frame while the previous one is being presented.
+ * The engine renders straight into a ring of two or three buffers (see
+ * acquire()); a frame is handed to the presenter thread, and its buffer
+ * back to the engine, by means of two atomic frame counters. The threads
+ * only wait (on a condition variable) when the ring is full or empty, and
+ * take the mutex to wake each other only when the other one is waiting.
+ * Frames are never dropped: when all the buffers are queued, the engine
+ * waits for the oldest one to be presented
+ */
+class AsyncFrameSink : public FrameSink
+{
+public:
+    enum {
+        MIN_BUFFERS = 2,
+        MAX_BUFFERS = 3
+    };
+
+    //! Present the frames to target through bufferCount buffers (clamped
+    //! to [MIN_BUFFERS, MAX_BUFFERS]); target must outlive this sink
+    AsyncFrameSink(FrameSink& target, int bufferCount = MIN_BUFFERS);
+
+    AsyncFrameSink(const AsyncFrameSink&) = delete;
+    AsyncFrameSink& operator=(const AsyncFrameSink&) = delete;
+
+    //! Present the frames still queued and stop the presenter thread
+    ~AsyncFrameSink();
+
+    bool ready() const noexcept override {
+        return m_target.ready();
+    }
+
+    //! Return the next buffer of the ring, waiting for it to be presented
+    //! if it is still queued
+    DWORD* acquire(int width, int height) override;
+
+    //! Queue a frame for presentation and return at once; the frame is
+    //! copied unless it was rendered into the acquired buffer
+    //! @return false if the target failed presenting a frame
+    bool present(const Frame& frame) override;
+
+    //! Wait until the frames queued have been presented
+    void flush();
+
+    //! Return true if the target failed presenting a frame
+    bool hasFailed() const noexcept {
+        return m_failed.load(std::memory_order_relaxed);
+    }
+
+    //! Return the number of frames presented to the target
+    size_t getFrameCount() const noexcept {
+        return m_presented.load(std::memory_order_acquire);
+    }
+
+    //! Return how many times the engine waited for a free buffer
+    size_t getStallCount() const noexcept {
+        return m_stallCount;
+    }
+
+private:
+    struct Buffer {
+        std::vector<DWORD> pixels;
+        Frame frame = Frame{ nullptr, 0, 0, 0 };
+    };
+
+    Buffer& waitForBuffer();
+
+    template <typename Ready>
+    void wait(Ready ready);
+
+    void notify();
+    void run();
+
+    FrameSink& m_target;
+    std::vector<Buffer> m_buffers;
+
+    // Frames queued by the engine and presented by the presenter thread:
+    // buffer n % size holds frame n, while m_presented <= n < m_queued
+    std::atomic<size_t> m_queued { 0 };
+    std::atomic<size_t> m_presented { 0 };
+    std::atomic<bool> m_failed { false };
+    std::atomic<bool> m_stop { false };
+
+    size_t m_stallCount = 0;
+
+    // Threads waiting on m_cv, notified only when there are any
+    std::atomic<int> m_waiters { 0 };
+
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::thread m_thread;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif // __ASYNCFRAMESINK_H__
@@ -1,51 +1,367 @@
-// This file is part of the WinRayCast Application (a 3D Engine Demo).
-// Copyright (C) 2005 - 2018
-// Antonino Calderone (antonino.calderone@gmail.com)
-// All rights reserved.  
-// Licensed under the MIT License. 
-// See COPYING file in the project root for full license information.
-
-
-/* -------------------------------------------------------------------------- */
-
-#include <windows.h>
-#pragma warning (disable: 4786)
-
-#include "BitmapBuffer.h"
-
-/* -------------------------------------------------------------------------- */
-
-BitmapBuffer::BitmapBuffer(HDC hdc, HBITMAP hBitmap, int dx, int dy) :
-    m_dx(dx), m_dy(dy)
-{
-    HDC texture_hdc = CreateCompatibleDC(hdc);
-
-    SelectObject(texture_hdc, hBitmap);
-
-    BITMAPINFO BmpInfo;
-
-    memset((void*)&BmpInfo, 0, sizeof(BITMAPINFOHEADER));
-    BmpInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-
-    BmpInfo.bmiHeader.biWidth = dx;
-    BmpInfo.bmiHeader.biHeight = -dy;
-
-    BmpInfo.bmiHeader.biPlanes = 1;
-    BmpInfo.bmiHeader.biBitCount = 32;
-    BmpInfo.bmiHeader.biCompression = BI_RGB;
-    BmpInfo.bmiHeader.biClrUsed = 0;
-    BmpInfo.bmiHeader.biClrImportant = 0;
-
-    _bitmap = new DWORD[dx*dy];
-
-    GetDIBits(
-        texture_hdc, 
-        hBitmap, 
-        0, dy, 
-        (LPVOID)_bitmap, 
-        &BmpInfo, 
-        DIB_RGB_COLORS);
-
-    DeleteDC(texture_hdc);
-}
-
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifdef _WIN32
+#include <windows.h>
+#pragma warning (disable: 4786)
+#endif
+
+#include "BitmapBuffer.h"
+
+#include "./miptknzr/include/mip_mmap_file.h"
+
+#include <string.h>
+
+// The 24 to 32 bit pixel expansion uses SSSE3 byte shuffles, which are
+// selected at run time unless the compiler targets them anyway
+#if defined(__SSSE3__) || defined(__AVX__)
+#define BITMAP_SSSE3
+#define BITMAP_SSSE3_TARGET
+#include <tmmintrin.h>
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define BITMAP_SSSE3
+#define BITMAP_SSSE3_CPUID
+#define BITMAP_SSSE3_TARGET __attribute__((target("ssse3")))
+#include <tmmintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define BITMAP_SSSE3
+#define BITMAP_SSSE3_CPUID
+#define BITMAP_SSSE3_TARGET
+#include <intrin.h>
+#include <tmmintrin.h>
+#endif
+
+
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+// BMP file and info header fields (little-endian)
+enum {
+    BMP_FILE_HEADER_SIZE = 14,
+    BMP_INFO_HEADER_SIZE = 40,
+    BMP_BI_RGB = 0,
+    BMP_BI_BITFIELDS = 3
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+uint32_t readU32(const uint8_t* p) noexcept
+{
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) |
+        (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+uint16_t readU16(const uint8_t* p) noexcept
+{
+    return uint16_t(p[0] | (p[1] << 8));
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifdef BITMAP_SSSE3
+
+bool hasSsse3() noexcept
+{
+#if !defined(BITMAP_SSSE3_CPUID)
+    return true;
+#elif defined(_MSC_VER)
+    int info[4] = { 0 };
+    __cpuid(info, 1);
+    return (info[2] & (1 << 9)) != 0;
+#else
+    return __builtin_cpu_supports("ssse3") != 0;
+#endif
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+// Expand 24 bit pixels 16 at a time (48 bytes from three 16 byte loads)
+// and return the number of pixels done; the remaining ones are left to
+// the caller
+BITMAP_SSSE3_TARGET
+int expandRow24Ssse3(const uint8_t* src, DWORD* dst, int count) noexcept
+{
+    const __m128i shuffle = _mm_setr_epi8(
+        0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11, -128);
+
+    int i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        const uint8_t* p = src + size_t(i) * 3;
+
+        const __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+        const __m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 32));
+
+        // pixels 0-3 start at byte 0, 4-7 at 12, 8-11 at 24, 12-15 at 36
+        const __m128i p0 = v0;
+        const __m128i p1 = _mm_alignr_epi8(v1, v0, 12);
+        const __m128i p2 = _mm_alignr_epi8(v2, v1, 8);
+        const __m128i p3 = _mm_srli_si128(v2, 4);
+
+        __m128i* out = reinterpret_cast<__m128i*>(dst + i);
+
+        _mm_storeu_si128(out, _mm_shuffle_epi8(p0, shuffle));
+        _mm_storeu_si128(out + 1, _mm_shuffle_epi8(p1, shuffle));
+        _mm_storeu_si128(out + 2, _mm_shuffle_epi8(p2, shuffle));
+        _mm_storeu_si128(out + 3, _mm_shuffle_epi8(p3, shuffle));
+    }
+
+    return i;
+}
+
+#endif
+
+
+/* -------------------------------------------------------------------------- */
+
+// Convert a row of B,G,R pixels into the 0x00RRGGBB layout of GetDIBits
+void expandRow24(const uint8_t* src, DWORD* dst, int count) noexcept
+{
+    int i = 0;
+
+#ifdef BITMAP_SSSE3
+    static const bool ssse3 = hasSsse3();
+
+    if (ssse3) {
+        i = expandRow24Ssse3(src, dst, count);
+    }
+#endif
+
+    for (; i < count; ++i) {
+        const uint8_t* p = src + size_t(i) * 3;
+        dst[i] = DWORD(p[0]) | (DWORD(p[1]) << 8) | (DWORD(p[2]) << 16);
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+// Convert a row of B,G,R,X pixels; the unused byte is cleared, since the
+// renderer compares pixels with RGB values (e.g. the transparent color)
+void copyRow32(const uint8_t* src, DWORD* dst, int count) noexcept
+{
+    memcpy(dst, src, size_t(count) * sizeof(DWORD));
+
+    for (int i = 0; i < count; ++i) {
+        dst[i] &= 0x00ffffff;
+    }
+}
+
+} // namespace
+
+
+/* -------------------------------------------------------------------------- */
+
+bool BitmapBuffer::load(const std::string& fileName, int dx, int dy)
+{
+    mip::mmap_file_t file;
+
+    if (!file.open(fileName)) {
+        return false;
+    }
+
+    return decode(file.data(), file.size(), dx, dy);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void BitmapBuffer::attach(const DWORD* pixels, int dx, int dy) noexcept
+{
+    m_bitmap.clear();
+    m_bitmap.shrink_to_fit();
+    m_pixels = pixels;
+    m_dx = dx;
+    m_dy = dy;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool BitmapBuffer::decode(const void* data, size_t size, int dx, int dy)
+{
+    const uint8_t* bmp = static_cast<const uint8_t*>(data);
+
+    if (!bmp || size < BMP_FILE_HEADER_SIZE + BMP_INFO_HEADER_SIZE ||
+        bmp[0] != 'B' || bmp[1] != 'M')
+    {
+        return false;
+    }
+
+    const uint8_t* info = bmp + BMP_FILE_HEADER_SIZE;
+
+    const size_t pixelOffset = readU32(bmp + 10);
+    const size_t infoSize = readU32(info);
+    const int32_t width = int32_t(readU32(info + 4));
+    const int32_t height = int32_t(readU32(info + 8));
+    const int bpp = readU16(info + 14);
+    const uint32_t compression = readU32(info + 16);
+
+    if (infoSize < BMP_INFO_HEADER_SIZE || readU16(info + 12) != 1 ||
+        width <= 0 || height == 0 || height == INT32_MIN ||
+        (bpp != 24 && bpp != 32))
+    {
+        return false;
+    }
+
+    if (compression == BMP_BI_BITFIELDS) {
+        // Only the default layout of 32 bit pixels is supported; the masks
+        // follow a 40 byte header or are part of a larger one
+        const size_t masksEnd = BMP_FILE_HEADER_SIZE + BMP_INFO_HEADER_SIZE + 12;
+
+        if (bpp != 32 || size < masksEnd ||
+            readU32(info + 40) != 0x00ff0000 ||
+            readU32(info + 44) != 0x0000ff00 ||
+            readU32(info + 48) != 0x000000ff)
+        {
+            return false;
+        }
+    }
+    else if (compression != BMP_BI_RGB) {
+        return false;
+    }
+
+    const bool topDown = height < 0;
+    const int srcDx = width;
+    const int srcDy = topDown ? -height : height;
+
+    // Rows are padded to 4 bytes, but the last one may be truncated
+    const size_t rowBytes = size_t(srcDx) * size_t(bpp / 8);
+    const size_t stride = (rowBytes + 3) & ~size_t(3);
+
+    if (pixelOffset > size ||
+        size - pixelOffset < rowBytes ||
+        (size - pixelOffset - rowBytes) / stride < size_t(srcDy - 1))
+    {
+        return false;
+    }
+
+    if (dx <= 0) {
+        dx = srcDx;
+    }
+
+    if (dy <= 0) {
+        dy = srcDy;
+    }
+
+    auto srcRow = [&](int y) {
+        return bmp + pixelOffset + stride * size_t(topDown ? y : srcDy - 1 - y);
+    };
+
+    auto convertRow = [bpp](const uint8_t* src, DWORD* dst, int count) {
+        if (bpp == 24) {
+            expandRow24(src, dst, count);
+        }
+        else {
+            copyRow32(src, dst, count);
+        }
+    };
+
+    m_bitmap.resize(size_t(dx) * size_t(dy));
+    m_pixels = m_bitmap.data();
+    m_dx = dx;
+    m_dy = dy;
+
+    if (dx == srcDx && dy == srcDy) {
+        for (int y = 0; y < dy; ++y) {
+            convertRow(srcRow(y), m_bitmap.data() + size_t(y) * size_t(dx), dx);
+        }
+
+        return true;
+    }
+
+    // Scaled image: nearest pixel sampling of the converted source rows
+    std::vector<DWORD> row(srcDx);
+    std::vector<int> srcX(dx);
+    int lastY = -1;
+
+    for (int x = 0; x < dx; ++x) {
+        srcX[x] = int(int64_t(x) * srcDx / dx);
+    }
+
+    for (int y = 0; y < dy; ++y) {
+        const int sy = int(int64_t(y) * srcDy / dy);
+
+        if (sy != lastY) {
+            convertRow(srcRow(sy), row.data(), srcDx);
+            lastY = sy;
+        }
+
+        DWORD* dst = m_bitmap.data() + size_t(y) * size_t(dx);
+
+        for (int x = 0; x < dx; ++x) {
+            dst[x] = row[srcX[x]];
+        }
+    }
+
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifdef _WIN32
+
+BitmapBuffer::BitmapBuffer(HDC hdc, HBITMAP hBitmap, int dx, int dy)
+{
+    copyBits(hdc, hBitmap, dx, dy);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool BitmapBuffer::copyBits(HDC hdc, HBITMAP hBitmap, int dx, int dy)
+{
+    m_dx = dx;
+    m_dy = dy;
+
+    HDC texture_hdc = CreateCompatibleDC(hdc);
+
+    SelectObject(texture_hdc, hBitmap);
+
+    BITMAPINFO BmpInfo;
+
+    memset((void*)&BmpInfo, 0, sizeof(BITMAPINFOHEADER));
+    BmpInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+
+    BmpInfo.bmiHeader.biWidth = dx;
+    BmpInfo.bmiHeader.biHeight = -dy;
+
+    BmpInfo.bmiHeader.biPlanes = 1;
+    BmpInfo.bmiHeader.biBitCount = 32;
+    BmpInfo.bmiHeader.biCompression = BI_RGB;
+    BmpInfo.bmiHeader.biClrUsed = 0;
+    BmpInfo.bmiHeader.biClrImportant = 0;
+
+    m_bitmap.assign(size_t(dx) * size_t(dy), 0);
+    m_pixels = m_bitmap.data();
+
+    const int lines = GetDIBits(
+        texture_hdc, 
+        hBitmap, 
+        0, dy, 
+        (LPVOID)m_bitmap.data(), 
+        &BmpInfo, 
+        DIB_RGB_COLORS);
+
+    DeleteDC(texture_hdc);
+
+    return lines > 0;
+}
+
+#endif // _WIN32
@@ -1,55 +1,119 @@
-// This file is part of the WinRayCast Application (a 3D Engine Demo).
-// Copyright (C) 2005 - 2018
-// Antonino Calderone (antonino.calderone@gmail.com)
-// All rights reserved.  
-// Licensed under the MIT License. 
-// See COPYING file in the project root for full license information.
-
-
-/* -------------------------------------------------------------------------- */
-
-#ifndef __BITMAPBUFFER_H__
-#define __BITMAPBUFFER_H__
-
-/* -------------------------------------------------------------------------- */
-
-#include <windows.h>
-#include <stdint.h>
-
-
-/* -------------------------------------------------------------------------- */
-
-class BitmapBuffer {
-public:
-    BitmapBuffer(HDC hdc, HBITMAP hBitmap, int dx, int dy);
-
-    virtual ~BitmapBuffer() { 
-        delete[] _bitmap; 
-    }
-
-    DWORD getPixel(unsigned int x, unsigned int y) const noexcept {
-        if ((x < (unsigned int)m_dx) && (y < (unsigned int)m_dy)) {
-            return _bitmap[(x + (y * m_dx))];
-        }
-
-        return 0;
-    }
-
-    void fillBuffer(void* destBuf, int offset, int org_dx) {
-        for (long y = 0; y < m_dy; ++y) {
-            for (int x = 0; x < m_dx; ++x) {
-                (*((DWORD*)destBuf + x + int64_t(y) * int64_t(m_dx))) = 
-                    getPixel((x + offset) % org_dx, y);
-            }
-        }
-    }
-
-private:
-    DWORD * _bitmap = nullptr;
-    int m_dx = 0, m_dy = 0;
-};
-
-
-/* -------------------------------------------------------------------------- */
-
-#endif // __BITMAPBUFFER_H__
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __BITMAPBUFFER_H__
+#define __BITMAPBUFFER_H__
+
+/* -------------------------------------------------------------------------- */
+
+#include "PlatformTypes.h"
+#include <stdint.h>
+#include <string>
+#include <string.h>
+#include <vector>
+
+
+/* -------------------------------------------------------------------------- */
+
+//! 32 bit pixels of a texture, ready to be sampled by the renderer
+class BitmapBuffer {
+public:
+    BitmapBuffer() = default;
+
+#ifdef _WIN32
+    BitmapBuffer(HDC hdc, HBITMAP hBitmap, int dx, int dy);
+#endif
+
+    BitmapBuffer(const BitmapBuffer&) = delete;
+    BitmapBuffer& operator=(const BitmapBuffer&) = delete;
+
+    virtual ~BitmapBuffer() {}
+
+    //! Load a bitmap file scaling it to dx x dy pixels (0 keeps the
+    //! image size); it can be called by any thread
+    //! @return false if the file cannot be loaded
+    bool load(const std::string& fileName, int dx = 0, int dy = 0);
+
+    /**
+     * Decode an in-memory BMP image (24 or 32 bits per pixel, uncompressed,
+     * top-down or bottom-up) scaling it to dx x dy pixels (0 keeps the
+     * image size)
+     * @return false if the image is not valid or not supported
+     */
+    bool decode(const void* data, size_t size, int dx = 0, int dy = 0);
+
+    /**
+     * Refer to dx x dy 32 bit pixels owned by someone else (e.g. an
+     * AssetPack mapped in memory): they are not copied and must outlive
+     * the buffer
+     */
+    void attach(const DWORD* pixels, int dx, int dy) noexcept;
+
+    //! Return the pixels, row by row
+    const DWORD* getPixels() const noexcept {
+        return m_pixels;
+    }
+
+    int getDx() const noexcept {
+        return m_dx;
+    }
+
+    int getDy() const noexcept {
+        return m_dy;
+    }
+
+    DWORD getPixel(unsigned int x, unsigned int y) const noexcept {
+        if ((x < (unsigned int)m_dx) && (y < (unsigned int)m_dy)) {
+            return m_pixels[(x + (y * m_dx))];
+        }
+
+        return 0;
+    }
+
+    //! Fill a destDx x destDy pixel buffer repeating the bitmap every
+    //! org_dx columns, starting from the column offset; the bitmap is
+    //! stretched to org_dx x destDy pixels, if it has a different size
+    void fillBuffer(void* destBuf, int destDx, int destDy, int offset, int org_dx) const {
+        if (m_dx <= 0 || m_dy <= 0) {
+            memset(destBuf, 0, size_t(destDx) * size_t(destDy) * sizeof(DWORD));
+            return;
+        }
+
+        std::vector<int> cols(destDx);
+
+        for (int x = 0; x < destDx; ++x) {
+            cols[x] = int(int64_t((x + offset) % org_dx) * m_dx / org_dx);
+        }
+
+        for (long y = 0; y < destDy; ++y) {
+            DWORD* dest = (DWORD*)destBuf + int64_t(y) * int64_t(destDx);
+            const DWORD* src = m_pixels + int64_t(y) * m_dy / destDy * m_dx;
+
+            for (int x = 0; x < destDx; ++x) {
+                dest[x] = src[cols[x]];
+            }
+        }
+    }
+
+private:
+#ifdef _WIN32
+    bool copyBits(HDC hdc, HBITMAP hBitmap, int dx, int dy);
+#endif
+
+    // Pixels refer to m_bitmap unless attached to external memory
+    std::vector<DWORD> m_bitmap;
+    const DWORD* m_pixels = nullptr;
+    int m_dx = 0, m_dy = 0;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif // __BITMAPBUFFER_H__
@@ -0,0 +1,103 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "DdxFrameSink.h"
+#include "DdxDevice.h"
+
+#include <string.h>
+
+
+/* -------------------------------------------------------------------------- */
+
+bool DdxFrameSink::ready() const noexcept
+{
+    return DdxDevice::getInstance().ready();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool DdxFrameSink::present(const Frame& frame)
+{
+    int x, y;
+    RECT rt;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+
+        x = m_x;
+        y = m_y;
+        rt = m_rt;
+    }
+
+    DdxDevice::Ctx dctx(DdxDevice::getInstance());
+
+    HDC dxHdc = dctx.getDc();
+
+    if (!dxHdc) {
+        return false;
+    }
+
+    BITMAPINFO BmpInfo;
+
+    memset((void*)&BmpInfo, 0, sizeof(BITMAPINFOHEADER));
+
+    // Top-down rows, pitch pixels wide
+    BmpInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    BmpInfo.bmiHeader.biWidth = frame.pitch;
+    BmpInfo.bmiHeader.biHeight = -frame.height;
+    BmpInfo.bmiHeader.biPlanes = 1;
+    BmpInfo.bmiHeader.biBitCount = 32;
+    BmpInfo.bmiHeader.biCompression = BI_RGB;
+    BmpInfo.bmiHeader.biClrUsed = 0;
+    BmpInfo.bmiHeader.biClrImportant = 0;
+
+    // Frames already scaled to the viewport (see ScalingFrameSink) are
+    // just copied
+    if (frame.width == rt.right && frame.height == rt.bottom) {
+        SetDIBitsToDevice(
+            dxHdc,                      // handle to DC
+            x,                          // x-coord of destination upper-left corner
+            y,                          // y-coord of destination upper-left corner
+            frame.width,                // width of source rectangle
+            frame.height,               // height of source rectangle
+            0,                          // x-coord of source lower-left corner
+            0,                          // y-coord of source lower-left corner
+            0,                          // first scan line in array
+            frame.height,               // number of scan lines
+            (CONST VOID *)frame.pixels, // bitmap bits
+            (CONST BITMAPINFO *)&BmpInfo, // bitmap data
+            DIB_RGB_COLORS              // usage options
+        );
+
+        return true;
+    }
+
+    StretchDIBits(
+        dxHdc,                          // handle to DC
+        x,                              // x-coord of destination upper-left corner
+        y,                              // y-coord of destination upper-left corner
+        rt.right,                       // width of destination rectangle
+        rt.bottom,                      // height of destination rectangle
+        0,                              // x-coord of source upper-left corner
+        0,                              // y-coord of source upper-left corner
+        frame.width,                    // width of source rectangle
+        frame.height,                   // height of source rectangle
+        (CONST VOID *)frame.pixels,     // bitmap bits
+        (CONST BITMAPINFO *)&BmpInfo,   // bitmap data
+        DIB_RGB_COLORS,                 // usage options
+        SRCCOPY                         // raster operation code
+    );
+
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
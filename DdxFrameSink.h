@@ -0,0 +1,54 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __DDXFRAMESINK_H__
+#define __DDXFRAMESINK_H__
+
+/* -------------------------------------------------------------------------- */
+
+#include "FrameSink.h"
+
+#include <mutex>
+
+
+/* -------------------------------------------------------------------------- */
+
+//! Stretches the frames to an area of the DirectDraw primary surface
+//! (see DdxDevice) by means of GDI, or copies them if they are as large
+//! as the area (see ScalingFrameSink). Frames can be presented by a thread
+//! other than the one setting the viewport (see AsyncFrameSink)
+class DdxFrameSink : public FrameSink
+{
+public:
+    //! Set the destination area: its top-left corner is at (x, y) of
+    //! the primary surface, and its size is rt.right x rt.bottom
+    void setViewport(int x, int y, const RECT& rt) {
+        std::lock_guard<std::mutex> lock(m_mtx);
+
+        m_x = x;
+        m_y = y;
+        m_rt = rt;
+    }
+
+    bool ready() const noexcept override;
+
+    bool present(const Frame& frame) override;
+
+private:
+    std::mutex m_mtx;
+    int m_x = 0;
+    int m_y = 0;
+    RECT m_rt = { 0 };
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif // __DDXFRAMESINK_H__
@@ -0,0 +1,507 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "FrameProfiler.h"
+
+#include <fstream>
+#include <stdio.h>
+#include <string.h>
+
+
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+// Frames averaged by the overlay
+const size_t OVERLAY_FRAMES = 30;
+
+// Bar length per millisecond, and longest bar, in font pixels
+const int BAR_PER_MS = 4;
+const int BAR_MAX = 64;
+
+// 3x5 pixel font of the characters ' ' ... '_' (lower case letters are
+// drawn as upper case ones): the 15 low bits are the rows, top to
+// bottom, 3 bits each, the leftmost pixel being the highest bit
+const uint16_t FONT[64] = {
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x52a5, 0x0000, 0x0000,  //  !"#$%&'
+    0x2922, 0x224a, 0x0000, 0x0000, 0x0000, 0x01c0, 0x0002, 0x12a4,  // ()*+,-./
+    0x7b6f, 0x2c97, 0x73e7, 0x73cf, 0x5bc9, 0x79cf, 0x79ef, 0x7252,  // 01234567
+    0x7bef, 0x7bcf, 0x0410, 0x0000, 0x0000, 0x0e38, 0x0000, 0x0000,  // 89:;<=>?
+    0x0000, 0x2bed, 0x6bae, 0x3923, 0x6b6e, 0x79a7, 0x79a4, 0x396b,  // @ABCDEFG
+    0x5bed, 0x7497, 0x126a, 0x5bad, 0x4927, 0x5fed, 0x6b6d, 0x2b6a,  // HIJKLMNO
+    0x6ba4, 0x2b73, 0x6bad, 0x388e, 0x7492, 0x5b6f, 0x5b6a, 0x5bfd,  // PQRSTUVW
+    0x5aad, 0x5a92, 0x72a7, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,  // XYZ[\]^_
+};
+
+// Colors of the stage bars
+const DWORD STAGE_COLORS[FrameProfiler::STAGE_COUNT] = {
+    0x0060a0ff,     // sky
+    0x0000c0ff,     // traversal
+    0x0040e040,     // floor and ceiling
+    0x00e0c000,     // walls
+    0x00e06000,     // transparent walls, internal
+    0x00e02080,     // transparent walls, external
+    0x00a0a0a0,     // overlay
+    0x00ff40ff,     // present
+};
+
+const char* const STAGE_LABELS[FrameProfiler::STAGE_COUNT] = {
+    "SKY",
+    "RAYS",
+    "FLOOR/CEIL",
+    "WALLS",
+    "TRANSP IN",
+    "TRANSP OUT",
+    "OVERLAY",
+    "PRESENT",
+};
+
+const char* const STAGE_NAMES[FrameProfiler::STAGE_COUNT] = {
+    "sky",
+    "traversal",
+    "floor_ceiling",
+    "walls",
+    "transp_internal",
+    "transp_external",
+    "overlay",
+    "present",
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+// Clipped drawing on a 32 bit pixel buffer
+class Canvas {
+public:
+    Canvas(DWORD* pixels, int width, int height, int pitch) noexcept :
+        m_pixels(pixels),
+        m_width(width),
+        m_height(height),
+        m_pitch(pitch)
+    {}
+
+    void fill(int x, int y, int dx, int dy, DWORD color) noexcept {
+        clip(x, y, dx, dy);
+
+        for (int j = 0; j < dy; ++j) {
+            DWORD* row = m_pixels + size_t(y + j) * size_t(m_pitch) + x;
+
+            for (int i = 0; i < dx; ++i) {
+                row[i] = color;
+            }
+        }
+    }
+
+    // Halve the brightness of an area
+    void darken(int x, int y, int dx, int dy) noexcept {
+        clip(x, y, dx, dy);
+
+        for (int j = 0; j < dy; ++j) {
+            DWORD* row = m_pixels + size_t(y + j) * size_t(m_pitch) + x;
+
+            for (int i = 0; i < dx; ++i) {
+                row[i] = (row[i] >> 1) & 0x007f7f7f;
+            }
+        }
+    }
+
+    // Draw a text with the 3x5 font, each font pixel being scale x scale
+    void print(int x, int y, const char* text, int scale, DWORD color) noexcept {
+        for (; *text; ++text, x += 4 * scale) {
+            int c = (unsigned char)*text;
+
+            if (c >= 'a' && c <= 'z') {
+                c -= 'a' - 'A';
+            }
+
+            const uint16_t glyph = c >= 32 && c < 96 ? FONT[c - 32] : 0;
+
+            for (int bit = 0; bit < 15; ++bit) {
+                if (glyph & (0x4000 >> bit)) {
+                    fill(x + (bit % 3) * scale, y + (bit / 3) * scale,
+                        scale, scale, color);
+                }
+            }
+        }
+    }
+
+private:
+    void clip(int& x, int& y, int& dx, int& dy) const noexcept {
+        if (x < 0) {
+            dx += x;
+            x = 0;
+        }
+
+        if (y < 0) {
+            dy += y;
+            y = 0;
+        }
+
+        if (x + dx > m_width) {
+            dx = m_width - x;
+        }
+
+        if (y + dy > m_height) {
+            dy = m_height - y;
+        }
+
+        if (dx < 0 || dy < 0) {
+            dx = dy = 0;
+        }
+    }
+
+    DWORD* m_pixels;
+    int m_width;
+    int m_height;
+    int m_pitch;
+};
+
+} // namespace
+
+
+/* -------------------------------------------------------------------------- */
+
+FrameProfiler::FrameProfiler(size_t capacity) :
+    m_samples(capacity < 1 ? 1 : capacity)
+{
+    for (auto & stage : m_stages) {
+        stage = Clock::duration::zero();
+    }
+
+    memset(m_eventBegin, 0, sizeof(m_eventBegin));
+    memset(m_eventMark, 0, sizeof(m_eventMark));
+    memset(m_stageEvents, 0, sizeof(m_stageEvents));
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void FrameProfiler::setMeter(Meter* meter, bool perStage) noexcept
+{
+    m_meter = meter && meter->getEventCount() > 0 ? meter : nullptr;
+    m_meterStages = m_meter && perStage;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void FrameProfiler::meterLap(Stage stage) noexcept
+{
+    uint64_t counts[MAX_EVENTS];
+
+    // A failed read leaves the events of the stage to the next one
+    if (!m_meterFrame || !m_meter->read(counts)) {
+        return;
+    }
+
+    // Counts scaled for multiplexing may even go back a little
+    for (int event = 0; event < m_meter->getEventCount(); ++event) {
+        if (counts[event] > m_eventMark[event]) {
+            m_stageEvents[stage][event] += counts[event] - m_eventMark[event];
+            m_eventMark[event] = counts[event];
+        }
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+FrameProfiler::Clock::time_point FrameProfiler::beginFrame() noexcept
+{
+    m_begin = Clock::now();
+
+    m_interval = m_lastBegin == Clock::time_point() ?
+        Clock::duration::zero() :
+        m_begin - m_lastBegin;
+
+    m_lastBegin = m_begin;
+
+    for (auto & stage : m_stages) {
+        stage = Clock::duration::zero();
+    }
+
+    if (m_meter) {
+        memset(m_stageEvents, 0, sizeof(m_stageEvents));
+
+        m_meterFrame = m_meter->read(m_eventBegin);
+        memcpy(m_eventMark, m_eventBegin, sizeof(m_eventMark));
+    }
+
+    return m_begin;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void FrameProfiler::endFrame(
+    int width,
+    int height,
+    const RenderCounters& counters) noexcept
+{
+    using Ms = std::chrono::duration<double, std::milli>;
+
+    Sample& sample = m_samples[m_next];
+
+    memset(sample.events, 0, sizeof(sample.events));
+    memset(sample.stageEvents, 0, sizeof(sample.stageEvents));
+
+    uint64_t counts[MAX_EVENTS];
+
+    // The events of a frame whose counts cannot be read are left to 0
+    if (m_meter && m_meterFrame && m_meter->read(counts)) {
+        for (int event = 0; event < m_meter->getEventCount(); ++event) {
+            sample.events[event] = counts[event] > m_eventBegin[event] ?
+                counts[event] - m_eventBegin[event] : 0;
+        }
+
+        if (m_meterStages) {
+            memcpy(sample.stageEvents, m_stageEvents, sizeof(sample.stageEvents));
+        }
+    }
+
+    sample.frame = m_frame++;
+    sample.width = width;
+    sample.height = height;
+    sample.interval = Ms(m_interval).count();
+    sample.total = Ms(Clock::now() - m_begin).count();
+
+    for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+        sample.stages[stage] = Ms(m_stages[stage]).count();
+    }
+
+    sample.counters = counters;
+
+    m_next = (m_next + 1) % m_samples.size();
+
+    if (m_count < m_samples.size()) {
+        ++m_count;
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+FrameProfiler::Sample FrameProfiler::getAverage(size_t count) const noexcept
+{
+    Sample avg = Sample{ 0, 0, 0, 0.0, 0.0, { 0.0 } };
+
+    if (count > m_count) {
+        count = m_count;
+    }
+
+    if (!count) {
+        return avg;
+    }
+
+    size_t intervals = 0;
+
+    for (size_t i = m_count - count; i < m_count; ++i) {
+        const Sample& sample = getSample(i);
+
+        // The first frame timed has no previous one
+        if (sample.interval > 0.0) {
+            avg.interval += sample.interval;
+            ++intervals;
+        }
+
+        avg.total += sample.total;
+
+        for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+            avg.stages[stage] += sample.stages[stage];
+        }
+
+        for (int counter = 0; counter < RenderCounters::COUNTER_COUNT; ++counter) {
+            avg.counters.values[counter] += sample.counters.values[counter];
+        }
+
+        for (int event = 0; event < MAX_EVENTS; ++event) {
+            avg.events[event] += sample.events[event];
+
+            for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+                avg.stageEvents[stage][event] += sample.stageEvents[stage][event];
+            }
+        }
+    }
+
+    const Sample& last = getSample(m_count - 1);
+
+    avg.frame = last.frame;
+    avg.width = last.width;
+    avg.height = last.height;
+    avg.interval = intervals ? avg.interval / intervals : 0.0;
+    avg.total /= count;
+
+    for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+        avg.stages[stage] /= count;
+    }
+
+    auto average = [count](uint64_t& sum) {
+        sum = (sum + count / 2) / count;
+    };
+
+    for (auto & value : avg.counters.values) {
+        average(value);
+    }
+
+    for (int event = 0; event < MAX_EVENTS; ++event) {
+        average(avg.events[event]);
+
+        for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+            average(avg.stageEvents[stage][event]);
+        }
+    }
+
+    return avg;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool FrameProfiler::writeCsv(std::ostream& os) const
+{
+    os << "frame,width,height,interval_ms,total_ms";
+
+    for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+        os << "," << getStageName(stage) << "_ms";
+    }
+
+    if (RenderCounters::ENABLED) {
+        for (int counter = 0; counter < RenderCounters::COUNTER_COUNT; ++counter) {
+            os << "," << RenderCounters::getName(counter);
+        }
+    }
+
+    const int events = m_meter ? m_meter->getEventCount() : 0;
+
+    for (int event = 0; event < events; ++event) {
+        os << "," << m_meter->getEventName(event);
+    }
+
+    for (int stage = 0; m_meterStages && stage < STAGE_COUNT; ++stage) {
+        for (int event = 0; event < events; ++event) {
+            os << "," << getStageName(stage) << "_" << m_meter->getEventName(event);
+        }
+    }
+
+    os << "\n";
+
+    char value[32];
+
+    auto put = [&](double ms) {
+        snprintf(value, sizeof(value), ",%.4f", ms);
+        os << value;
+    };
+
+    for (size_t i = 0; i < m_count; ++i) {
+        const Sample& sample = getSample(i);
+
+        os << sample.frame << "," << sample.width << "," << sample.height;
+
+        put(sample.interval);
+        put(sample.total);
+
+        for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+            put(sample.stages[stage]);
+        }
+
+        if (RenderCounters::ENABLED) {
+            for (auto count : sample.counters.values) {
+                os << "," << count;
+            }
+        }
+
+        for (int event = 0; event < events; ++event) {
+            os << "," << sample.events[event];
+        }
+
+        for (int stage = 0; m_meterStages && stage < STAGE_COUNT; ++stage) {
+            for (int event = 0; event < events; ++event) {
+                os << "," << sample.stageEvents[stage][event];
+            }
+        }
+
+        os << "\n";
+    }
+
+    return bool(os);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool FrameProfiler::writeCsv(const std::string& fileName) const
+{
+    std::ofstream os(fileName);
+
+    return os.is_open() && writeCsv(os) && bool(os.flush());
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void FrameProfiler::drawOverlay(DWORD* pixels, int width, int height, int pitch) const
+{
+    const Sample avg = getAverage(OVERLAY_FRAMES);
+
+    // Font pixels are doubled on frames large enough
+    const int scale = width >= 400 ? 2 : 1;
+    const int lineHeight = 7 * scale;
+    const int margin = 2 * scale;
+    const int textWidth = 18 * 4 * scale;
+
+    Canvas canvas(pixels, width, height, pitch);
+
+    canvas.darken(0, 0,
+        margin * 2 + textWidth + BAR_MAX * scale,
+        margin * 2 + lineHeight * (STAGE_COUNT + 1));
+
+    char line[64];
+
+    snprintf(line, sizeof(line), "FPS %5.1f %6.2f MS",
+        avg.interval > 0.0 ? 1000.0 / avg.interval : 0.0, avg.total);
+
+    canvas.print(margin, margin, line, scale, 0x00ffffff);
+
+    for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+        const int y = margin + lineHeight * (stage + 1);
+        const double ms = avg.stages[stage];
+
+        snprintf(line, sizeof(line), "%-10s %6.2f", getStageLabel(stage), ms);
+        canvas.print(margin, y, line, scale, 0x00ffffff);
+
+        int bar = int(ms * BAR_PER_MS + 0.5);
+
+        if (bar > BAR_MAX) {
+            bar = BAR_MAX;
+        }
+
+        canvas.fill(margin + textWidth, y, bar * scale, 5 * scale,
+            STAGE_COLORS[stage]);
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+const char* FrameProfiler::getStageLabel(int stage) noexcept
+{
+    return stage >= 0 && stage < STAGE_COUNT ? STAGE_LABELS[stage] : "";
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+const char* FrameProfiler::getStageName(int stage) noexcept
+{
+    return stage >= 0 && stage < STAGE_COUNT ? STAGE_NAMES[stage] : "";
+}
+
+
+/* -------------------------------------------------------------------------- */
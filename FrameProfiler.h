@@ -0,0 +1,203 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __FRAMEPROFILER_H__
+#define __FRAMEPROFILER_H__
+
+/* -------------------------------------------------------------------------- */
+
+#include "PlatformTypes.h"
+#include "RenderCounters.h"
+
+#include <chrono>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Times the stages of the frames rendered by RaycastEngine (see
+ * RaycastEngine::setProfiler) and keeps the timings of the most recent
+ * frames in a ring buffer. The timings can be read back, written to a CSV
+ * file, or drawn over the frame itself. Stages interleaved per ray (ray
+ * traversal, floor and ceiling, walls) are accumulated over the rays of
+ * the frame. The work counters of the frame (see RenderCounters.h) are
+ * kept next to the timings. When the profiler is disabled, the engine
+ * only tests a flag per frame. It is meant to be used by the rendering
+ * thread only
+ */
+class FrameProfiler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum Stage {
+        SKY,                //!< sky fill (or clear) of the frame
+        TRAVERSAL,          //!< rays crossing the map up to a wall
+        FLOOR_CEILING,      //!< floor and ceiling of each ray
+        WALLS,              //!< walls (upper walls included)
+        TRANSP_INTERNAL,    //!< transparent walls, internal pass
+        TRANSP_EXTERNAL,    //!< transparent walls, external pass
+        OVERLAY,            //!< drawing of this profiler overlay
+        PRESENT,            //!< buffer acquisition and presentation
+        STAGE_COUNT
+    };
+
+    enum {
+        //! Events counted by a meter, at most
+        MAX_EVENTS = 8
+    };
+
+    //! Source of event counts read along with the clock (e.g. hardware
+    //! counters, see tools/PerfCounters.h)
+    class Meter {
+    public:
+        virtual ~Meter() {}
+
+        //! Return the number of events counted (at most MAX_EVENTS)
+        virtual int getEventCount() const noexcept = 0;
+
+        //! Return the name of an event, as in the CSV header
+        virtual const char* getEventName(int event) const noexcept = 0;
+
+        //! Read the running counts of the events
+        //! @return false, leaving counts unchanged, if they cannot be read
+        virtual bool read(uint64_t* counts) noexcept = 0;
+    };
+
+    //! Timings of a frame, in milliseconds, and event counts
+    struct Sample {
+        uint64_t frame;
+        int width;
+        int height;
+        double interval;    //!< since the beginning of the previous frame
+        double total;       //!< from the beginning to the end of the frame
+        double stages[STAGE_COUNT];
+        RenderCounters counters;
+        uint64_t events[MAX_EVENTS];
+        uint64_t stageEvents[STAGE_COUNT][MAX_EVENTS];
+    };
+
+    //! Keep the timings of the last capacity frames
+    explicit FrameProfiler(size_t capacity = 256);
+
+    bool isEnabled() const noexcept {
+        return m_enabled;
+    }
+
+    //! Start or stop timing the frames (the samples are kept)
+    void setEnabled(bool enabled) noexcept {
+        m_enabled = enabled;
+        m_lastBegin = Clock::time_point();
+    }
+
+    bool isOverlayVisible() const noexcept {
+        return m_overlay;
+    }
+
+    //! Draw the timings over the frames (see drawOverlay)
+    void setOverlayVisible(bool visible) noexcept {
+        m_overlay = visible;
+    }
+
+    //! Count the events of a meter (nullptr for none) in each frame, and
+    //! in each stage if perStage is true: the meter is read at every
+    //! lap then, which is usually far more expensive than the clock
+    void setMeter(Meter* meter, bool perStage) noexcept;
+
+    Meter* getMeter() const noexcept {
+        return m_meter;
+    }
+
+    bool isMeteringStages() const noexcept {
+        return m_meter && m_meterStages;
+    }
+
+    //! Start timing a frame, return the time the first stage begins at
+    Clock::time_point beginFrame() noexcept;
+
+    //! Account the time elapsed since a mark to a stage, and return
+    //! the time the next stage begins at
+    Clock::time_point lap(Stage stage, Clock::time_point mark) noexcept {
+        const auto now = Clock::now();
+        m_stages[stage] += now - mark;
+
+        if (m_meterStages) {
+            meterLap(stage);
+        }
+
+        return now;
+    }
+
+    //! Store the timings and the counters of the frame in the ring buffer
+    void endFrame(int width, int height, const RenderCounters& counters) noexcept;
+
+    //! Return the number of frames in the ring buffer
+    size_t getSampleCount() const noexcept {
+        return m_count;
+    }
+
+    //! Return the i-th frame in the ring buffer (0 is the oldest one)
+    const Sample& getSample(size_t i) const noexcept {
+        return m_samples[(m_next + m_samples.size() - m_count + i) % m_samples.size()];
+    }
+
+    //! Return the average timings of the last count frames (or of all
+    //! the frames, if there are fewer)
+    Sample getAverage(size_t count) const noexcept;
+
+    //! Write the frames of the ring buffer as CSV, one per line (the
+    //! counters are written only if compiled in, the events only if
+    //! there is a meter)
+    bool writeCsv(std::ostream& os) const;
+    bool writeCsv(const std::string& fileName) const;
+
+    //! Draw the average timings of the last frames (frame rate, and the
+    //! time of each stage as a number and as a bar) at the top-left of
+    //! a width x height 32 bit pixel buffer
+    void drawOverlay(DWORD* pixels, int width, int height, int pitch) const;
+
+    //! Return the label of a stage, as shown by the overlay
+    static const char* getStageLabel(int stage) noexcept;
+
+    //! Return the name of a stage, as in the CSV header
+    static const char* getStageName(int stage) noexcept;
+
+private:
+    void meterLap(Stage stage) noexcept;
+
+    std::vector<Sample> m_samples;
+    size_t m_next = 0;
+    size_t m_count = 0;
+    uint64_t m_frame = 0;
+
+    bool m_enabled = false;
+    bool m_overlay = false;
+
+    Clock::time_point m_begin;
+    Clock::time_point m_lastBegin;
+    Clock::duration m_interval = Clock::duration::zero();
+    Clock::duration m_stages[STAGE_COUNT];
+
+    Meter* m_meter = nullptr;
+    bool m_meterStages = false;
+    bool m_meterFrame = false;  //!< the counts of the frame begin were read
+    uint64_t m_eventBegin[MAX_EVENTS];
+    uint64_t m_eventMark[MAX_EVENTS];
+    uint64_t m_stageEvents[STAGE_COUNT][MAX_EVENTS];
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif // __FRAMEPROFILER_H__
@@ -0,0 +1,194 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "FrameSink.h"
+
+#include <string.h>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#define popen _popen
+#define pclose _pclose
+#define POPEN_WRITE "wb"
+#else
+#define POPEN_WRITE "w"
+#endif
+
+
+/* -------------------------------------------------------------------------- */
+
+bool MemoryFrameSink::present(const Frame& frame)
+{
+    m_pixels.resize(size_t(frame.width) * size_t(frame.height));
+    m_width = frame.width;
+    m_height = frame.height;
+
+    for (int y = 0; y < frame.height; ++y) {
+        memcpy(m_pixels.data() + size_t(y) * size_t(frame.width),
+            frame.pixels + size_t(y) * size_t(frame.pitch),
+            size_t(frame.width) * sizeof(DWORD));
+    }
+
+    ++m_frameCount;
+
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+FileFrameSink::FileFrameSink(const std::string& fileName, Format format) :
+    m_fileName(fileName),
+    m_format(format)
+{
+    if (m_format == Format::RAW) {
+        m_file = open(m_fileName);
+        m_ok = m_file != nullptr;
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+FileFrameSink::~FileFrameSink()
+{
+    close();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+FILE* FileFrameSink::open(const std::string& fileName)
+{
+    m_pipe = false;
+
+    if (fileName == "-") {
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        return stdout;
+    }
+
+    if (!fileName.empty() && fileName[0] == '|') {
+        m_pipe = true;
+        return popen(fileName.c_str() + 1, POPEN_WRITE);
+    }
+
+    return fopen(fileName.c_str(), "wb");
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void FileFrameSink::close() noexcept
+{
+    if (!m_file) {
+        return;
+    }
+
+    if (m_pipe) {
+        pclose(m_file);
+    }
+    else if (m_file != stdout) {
+        fclose(m_file);
+    }
+    else {
+        fflush(m_file);
+    }
+
+    m_file = nullptr;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool FileFrameSink::present(const Frame& frame)
+{
+    if (!m_ok) {
+        return false;
+    }
+
+    if (m_format == Format::BMP) {
+        std::string fileName = m_fileName;
+        const size_t pos = fileName.find("%d");
+
+        if (pos != std::string::npos) {
+            fileName.replace(pos, 2, std::to_string(m_frameCount));
+        }
+
+        m_file = open(fileName);
+        m_ok = m_file && writeBmp(m_file, frame);
+
+        close();
+    }
+    else {
+        for (int y = 0; m_ok && y < frame.height; ++y) {
+            m_ok = fwrite(frame.pixels + size_t(y) * size_t(frame.pitch),
+                sizeof(DWORD), size_t(frame.width), m_file) == size_t(frame.width);
+        }
+    }
+
+    ++m_frameCount;
+
+    return m_ok;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool FileFrameSink::writeBmp(FILE* file, const Frame& frame)
+{
+    const uint32_t imageSize = uint32_t(frame.width) * uint32_t(frame.height) * 4;
+
+    uint8_t hdr[14 + 40] = { 0 };
+
+    auto put16 = [&hdr](size_t offset, uint32_t value) {
+        hdr[offset] = uint8_t(value);
+        hdr[offset + 1] = uint8_t(value >> 8);
+    };
+
+    auto put32 = [&hdr](size_t offset, uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            hdr[offset + i] = uint8_t(value >> (8 * i));
+        }
+    };
+
+    // File header
+    hdr[0] = 'B';
+    hdr[1] = 'M';
+    put32(2, uint32_t(sizeof(hdr)) + imageSize);
+    put32(10, uint32_t(sizeof(hdr)));
+
+    // Info header: 32 bit BI_RGB, top-down
+    put32(14, 40);
+    put32(18, uint32_t(frame.width));
+    put32(22, uint32_t(-frame.height));
+    put16(26, 1);
+    put16(28, 32);
+    put32(34, imageSize);
+
+    if (fwrite(hdr, sizeof(hdr), 1, file) != 1) {
+        return false;
+    }
+
+    for (int y = 0; y < frame.height; ++y) {
+        if (fwrite(frame.pixels + size_t(y) * size_t(frame.pitch),
+            sizeof(DWORD), size_t(frame.width), file) != size_t(frame.width))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
@@ -0,0 +1,159 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __FRAMESINK_H__
+#define __FRAMESINK_H__
+
+/* -------------------------------------------------------------------------- */
+
+#include "PlatformTypes.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+
+/* -------------------------------------------------------------------------- */
+
+//! Image rendered by the engine: height rows of width 32 bit pixels (the
+//! layout of BitmapBuffer), the first pixels of two rows being pitch
+//! pixels apart
+struct Frame {
+    const DWORD* pixels;
+    int width;
+    int height;
+    int pitch;
+
+    DWORD getPixel(int x, int y) const noexcept {
+        return pixels[size_t(y) * size_t(pitch) + size_t(x)];
+    }
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+//! Destination of the rendered frames (a display, memory, a file...)
+class FrameSink
+{
+public:
+    virtual ~FrameSink() {}
+
+    //! Return false if frames cannot be presented now (e.g. the display
+    //! is not available): the renderer skips the frame
+    virtual bool ready() const noexcept {
+        return true;
+    }
+
+    //! Return a buffer of width x height pixels (pitch = width) for the
+    //! renderer to draw the next frame into, before presenting it; the
+    //! default nullptr lets the renderer use a buffer of its own
+    virtual DWORD* acquire(int width, int height) {
+        (void)width;
+        (void)height;
+        return nullptr;
+    }
+
+    //! Present a frame; its pixels are valid during the call only
+    //! @return false on error
+    virtual bool present(const Frame& frame) = 0;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+//! Keeps a copy of the last frame in memory, so that rendering can run
+//! without a display (e.g. benchmarks and regression tests)
+class MemoryFrameSink : public FrameSink
+{
+public:
+    bool present(const Frame& frame) override;
+
+    //! Return the last frame (no pixels before the first one)
+    Frame getFrame() const noexcept {
+        return Frame{ m_pixels.data(), m_width, m_height, m_width };
+    }
+
+    int getWidth() const noexcept {
+        return m_width;
+    }
+
+    int getHeight() const noexcept {
+        return m_height;
+    }
+
+    size_t getFrameCount() const noexcept {
+        return m_frameCount;
+    }
+
+private:
+    std::vector<DWORD> m_pixels;
+    int m_width = 0;
+    int m_height = 0;
+    size_t m_frameCount = 0;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Writes the frames to a file or to a pipe, either as a stream of raw
+ * frames (width x height 32 bit BGRX pixels each, e.g. for an encoder
+ * reading raw video), or as a BMP file per frame. The file name "-" is
+ * the standard output, while a name beginning with '|' is a command
+ * whose standard input receives the frames. In BMP format a "%d" in the
+ * file name is replaced by the frame number
+ */
+class FileFrameSink : public FrameSink
+{
+public:
+    enum class Format {
+        RAW,
+        BMP
+    };
+
+    FileFrameSink(const std::string& fileName, Format format = Format::RAW);
+
+    FileFrameSink(const FileFrameSink&) = delete;
+    FileFrameSink& operator=(const FileFrameSink&) = delete;
+
+    ~FileFrameSink();
+
+    //! Return false if the file or the pipe could not be opened (in BMP
+    //! format, if a frame could not be written)
+    bool isOpen() const noexcept {
+        return m_ok;
+    }
+
+    bool present(const Frame& frame) override;
+
+    size_t getFrameCount() const noexcept {
+        return m_frameCount;
+    }
+
+    //! Write a frame to a BMP (32 bit, top-down) file
+    static bool writeBmp(FILE* file, const Frame& frame);
+
+private:
+    FILE* open(const std::string& fileName);
+    void close() noexcept;
+
+    std::string m_fileName;
+    Format m_format;
+    FILE* m_file = nullptr;
+    bool m_pipe = false;
+    bool m_ok = true;
+    size_t m_frameCount = 0;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif // __FRAMESINK_H__
@@ -0,0 +1,58 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __PLATFORMTYPES_H__
+#define __PLATFORMTYPES_H__
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifdef _WIN32
+
+#include <windows.h>
+#pragma warning (disable: 4786)
+
+#else
+
+// Minimal subset of the Win32 types and macros used by the engine core
+// (map, player, textures, renderer), so that it can be built on Linux
+// by the tools (map generator, benchmarks) without a Windows SDK
+
+#include <stdint.h>
+#include <string.h>
+
+typedef uint8_t BYTE;
+typedef uint16_t WORD;
+typedef uint32_t DWORD;
+typedef DWORD COLORREF;
+
+typedef struct HBITMAP__ * HBITMAP;
+typedef struct HDC__ * HDC;
+
+typedef struct tagRECT {
+    long left;
+    long top;
+    long right;
+    long bottom;
+} RECT;
+
+#define RGB(r,g,b) \
+    ((COLORREF)(((BYTE)(r)|((WORD)((BYTE)(g))<<8))|(((DWORD)(BYTE)(b))<<16)))
+
+#define GetRValue(rgb) ((BYTE)(rgb))
+#define GetGValue(rgb) ((BYTE)(((WORD)(rgb)) >> 8))
+#define GetBValue(rgb) ((BYTE)((rgb)>>16))
+
+#endif // _WIN32
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif // __PLATFORMTYPES_H__
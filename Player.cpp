@@ -1,124 +1,186 @@
-// This file is part of the WinRayCast Application (a 3D Engine Demo).
-// Copyright (C) 2005 - 2018
-// Antonino Calderone (antonino.calderone@gmail.com)
-// All rights reserved.  
-// Licensed under the MIT License. 
-// See COPYING file in the project root for full license information.
-
-
-/* -------------------------------------------------------------------------- */
-
-#include "Player.h"
-#include "WorldMap.h"
-
-
-/* -------------------------------------------------------------------------- */
-
-Player::Cell Player::moveTo(int offset, WorldMap& wMap, int deg)
-{
-    Cell retVal = 0;
-
-    try {
-        int alpha = m_alpha + degHalfVisual() + deg;
-        
-        if (alpha >= m_deg360) {
-            alpha -= m_deg360;
-        }
-        else if (alpha < 0) {
-            alpha += m_deg360;
-        }
-
-        double x = double(offset)*m_cosTbl[alpha];
-        double y = double(offset)*m_sinTbl[alpha];
-
-        const int c = (int)(m_x + x) / wMap.getCellDx();
-        const int r = (int)(m_y + y) / wMap.getCellDy();
-
-        if (r >= wMap.getRowCount() || c >= wMap.getColCount()) {
-            return retVal;
-        }
-
-        retVal = wMap[r][c];
-
-        if ((retVal & 0x000000ff) == 0) {
-            m_x += x;
-            m_y += y;
-        }
-    }
-    catch (...) {
-    }
-
-    return retVal;
-}
-
-/* -------------------------------------------------------------------------- */
-
-static const double POSITIVE_INFINITY = 1000000.0;
-static const double SMALLEST_EPSILON = double(1.0) / POSITIVE_INFINITY;
-
-
-/* -------------------------------------------------------------------------- */
-
-Player::Player(
-    int x, int y,
-    int visualDeg,
-    int xProjRes, int yProjRes,
-    int slope,
-    double projCenter) noexcept :
-    m_x(x),
-    m_y(y),
-    m_alpha(0),
-    m_visualDeg(visualDeg),
-    m_xProjRes(xProjRes),
-    m_yProjRes(yProjRes),
-    m_slope(slope),
-    m_projCenter(projCenter)
-{
-    auto sign = [](double x) {
-        return x == 0.0 ? 0.0 : (x>.0 ? 1. : -1.);
-    };
-
-    m_floorShadingPar = yProjRes / 16;
-
-    const int vecSize = m_xProjRes * (360 / m_visualDeg);
-
-    m_degVisual = (vecSize * m_visualDeg) / 360;
-    m_degVisual2 = m_degVisual / 2;
-
-    m_deg90 = vecSize / 4;
-    m_deg180 = vecSize / 2;
-    m_deg270 = (vecSize / 4) * 3;
-    m_deg360 = vecSize - 1;
-
-    m_cosTbl.resize(vecSize);
-    m_sinTbl.resize(vecSize);
-    m_tanTbl.resize(vecSize);
-    m_invSinTbl.resize(vecSize);
-    m_invCosTbl.resize(vecSize);
-    m_invTanTbl.resize(vecSize);
-
-    for (int ray = 0; ray < vecSize; ++ray) {
-        const double alpha = 
-           (double(ray*360.0) / double(m_deg360))*(3.14159265359 / 180.0);
-
-        m_cosTbl[ray] = ::cos(alpha);
-        m_sinTbl[ray] = ::sin(alpha);
-        m_tanTbl[ray] = ::tan(alpha);
-
-        m_invCosTbl[ray] = fabs(m_cosTbl[ray]) <= SMALLEST_EPSILON ?
-            sign(m_cosTbl[ray]) * POSITIVE_INFINITY :
-            double(1.0) / m_cosTbl[ray];
-
-        m_invSinTbl[ray] = fabs(m_sinTbl[ray]) <= SMALLEST_EPSILON ?
-            sign(m_cosTbl[ray]) * POSITIVE_INFINITY :
-            double(1.0) / m_sinTbl[ray];
-
-        m_invTanTbl[ray] = fabs(m_tanTbl[ray]) <= SMALLEST_EPSILON ?
-            sign(m_cosTbl[ray]) * POSITIVE_INFINITY :
-            double(1.0) / m_tanTbl[ray];
-    }
-
-}
-
-/* -------------------------------------------------------------------------- */
-
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "Player.h"
+#include "WorldMap.h"
+
+
+/* -------------------------------------------------------------------------- */
+
+Player::Cell Player::moveTo(int offset, WorldMap& wMap, int deg)
+{
+    Cell retVal = 0;
+
+    try {
+        int alpha = m_alpha + degHalfVisual() + deg;
+        
+        if (alpha >= m_deg360) {
+            alpha -= m_deg360;
+        }
+        else if (alpha < 0) {
+            alpha += m_deg360;
+        }
+
+        double x = double(offset)*m_cosTbl[alpha];
+        double y = double(offset)*m_sinTbl[alpha];
+
+        const int c = (int)(m_x + x) / wMap.getCellDx();
+        const int r = (int)(m_y + y) / wMap.getCellDy();
+
+        if (r >= wMap.getRowCount() || c >= wMap.getColCount()) {
+            return retVal;
+        }
+
+        retVal = wMap[r][c];
+
+        if ((retVal & 0x000000ff) == 0) {
+            m_x += x;
+            m_y += y;
+        }
+    }
+    catch (...) {
+    }
+
+    return retVal;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static const double POSITIVE_INFINITY = 1000000.0;
+static const double SMALLEST_EPSILON = double(1.0) / POSITIVE_INFINITY;
+
+
+/* -------------------------------------------------------------------------- */
+
+Player::Player(
+    int x, int y,
+    int visualDeg,
+    int xProjRes, int yProjRes,
+    int slope,
+    double projCenter) noexcept :
+    m_x(x),
+    m_y(y),
+    m_alpha(0),
+    m_visualDeg(visualDeg),
+    m_xProjRes(xProjRes),
+    m_yProjRes(yProjRes),
+    m_slope(slope),
+    m_projCenter(projCenter)
+{
+    m_floorShadingPar = yProjRes / 16;
+
+    selectTables(xProjRes);
+}
+
+/* -------------------------------------------------------------------------- */
+
+const Player::Tables& Player::getTables(int xProjRes)
+{
+    auto& tables = m_tables[xProjRes];
+
+    if (tables) {
+        return *tables;
+    }
+
+    auto sign = [](double x) {
+        return x == 0.0 ? 0.0 : (x>.0 ? 1. : -1.);
+    };
+
+    auto tbl = std::make_shared<Tables>();
+
+    const int vecSize = xProjRes * (360 / m_visualDeg);
+
+    tbl->degVisual = (vecSize * m_visualDeg) / 360;
+    tbl->degVisual2 = tbl->degVisual / 2;
+
+    tbl->deg90 = vecSize / 4;
+    tbl->deg180 = vecSize / 2;
+    tbl->deg270 = (vecSize / 4) * 3;
+    tbl->deg360 = vecSize - 1;
+
+    tbl->cosTbl.resize(vecSize);
+    tbl->sinTbl.resize(vecSize);
+    tbl->tanTbl.resize(vecSize);
+    tbl->invSinTbl.resize(vecSize);
+    tbl->invCosTbl.resize(vecSize);
+    tbl->invTanTbl.resize(vecSize);
+
+    for (int ray = 0; ray < vecSize; ++ray) {
+        const double alpha = 
+           (double(ray*360.0) / double(tbl->deg360))*(3.14159265359 / 180.0);
+
+        tbl->cosTbl[ray] = ::cos(alpha);
+        tbl->sinTbl[ray] = ::sin(alpha);
+        tbl->tanTbl[ray] = ::tan(alpha);
+
+        tbl->invCosTbl[ray] = fabs(tbl->cosTbl[ray]) <= SMALLEST_EPSILON ?
+            sign(tbl->cosTbl[ray]) * POSITIVE_INFINITY :
+            double(1.0) / tbl->cosTbl[ray];
+
+        tbl->invSinTbl[ray] = fabs(tbl->sinTbl[ray]) <= SMALLEST_EPSILON ?
+            sign(tbl->cosTbl[ray]) * POSITIVE_INFINITY :
+            double(1.0) / tbl->sinTbl[ray];
+
+        tbl->invTanTbl[ray] = fabs(tbl->tanTbl[ray]) <= SMALLEST_EPSILON ?
+            sign(tbl->cosTbl[ray]) * POSITIVE_INFINITY :
+            double(1.0) / tbl->tanTbl[ray];
+    }
+
+    tables = std::move(tbl);
+
+    return *tables;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Player::selectTables(int xProjRes)
+{
+    const Tables& tbl = getTables(xProjRes);
+
+    m_degVisual = tbl.degVisual;
+    m_degVisual2 = tbl.degVisual2;
+
+    m_deg90 = tbl.deg90;
+    m_deg180 = tbl.deg180;
+    m_deg270 = tbl.deg270;
+    m_deg360 = tbl.deg360;
+
+    m_cosTbl = tbl.cosTbl.data();
+    m_sinTbl = tbl.sinTbl.data();
+    m_tanTbl = tbl.tanTbl.data();
+    m_invSinTbl = tbl.invSinTbl.data();
+    m_invCosTbl = tbl.invCosTbl.data();
+    m_invTanTbl = tbl.invTanTbl.data();
+
+    m_xProjRes = xProjRes;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Player::setProjRes(int xProjRes, int yProjRes)
+{
+    if (xProjRes == m_xProjRes && yProjRes == m_yProjRes) {
+        return;
+    }
+
+    const int deg360 = m_deg360;
+    const int yRes = m_yProjRes;
+
+    selectTables(xProjRes);
+
+    m_yProjRes = yProjRes;
+    m_floorShadingPar = yProjRes / 16;
+
+    setAlpha(int(lround(double(m_alpha) * m_deg360 / deg360)));
+    m_slope = int(lround(double(m_slope) * yProjRes / yRes));
+}
+
+/* -------------------------------------------------------------------------- */
+
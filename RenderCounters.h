@@ -0,0 +1,160 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __RENDERCOUNTERS_H__
+#define __RENDERCOUNTERS_H__
+
+/* -------------------------------------------------------------------------- */
+
+#include <stdint.h>
+
+
+/* -------------------------------------------------------------------------- */
+
+// The counters are compiled in the render core if RENDER_COUNTERS is
+// defined as 1 (e.g. make COUNTERS=1 for the Linux tools), which is the
+// default of debug builds. Otherwise RENDER_COUNT(expr) expands to
+// nothing and the counters stay zero
+#ifndef RENDER_COUNTERS
+#ifdef _DEBUG
+#define RENDER_COUNTERS 1
+#else
+#define RENDER_COUNTERS 0
+#endif
+#endif
+
+#if RENDER_COUNTERS
+#define RENDER_COUNT(expr) ((void)(expr))
+#else
+#define RENDER_COUNT(expr) ((void)0)
+#endif
+
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Work done by RaycastEngine to render a frame: rays cast and grid cells
+ * crossed (before reaching a wall) by each pass, rays of the main pass by
+ * number of cells crossed (a histogram of power of two buckets), pixels
+ * drawn by each part of the scene, texture lookups and texel fetches.
+ * PIXELS_WRITTEN counts the pixels drawn over the sky, PIXELS_OVERWRITTEN
+ * the further writes to any of them (overdraw)
+ */
+struct RenderCounters
+{
+    enum Pass {
+        MAIN,
+        TRANSP_INTERNAL,
+        TRANSP_EXTERNAL,
+        PASS_COUNT
+    };
+
+    enum Counter {
+        RAYS,                                       //!< per pass
+        CELLS = RAYS + PASS_COUNT,                  //!< per pass
+        RAYS_UPTO_2_CELLS = CELLS + PASS_COUNT,     //!< main pass histogram
+        RAYS_UPTO_4_CELLS,
+        RAYS_UPTO_8_CELLS,
+        RAYS_UPTO_16_CELLS,
+        RAYS_UPTO_32_CELLS,
+        RAYS_UPTO_64_CELLS,
+        RAYS_UPTO_128_CELLS,
+        RAYS_OVER_128_CELLS,
+        CEILING_PIXELS,
+        FLOOR_PIXELS,
+        WALL_PIXELS,                                //!< upper walls included
+        TRANSP_PIXELS,
+        TRANSP_REJECTED,                            //!< transparent texels
+        TEXTURE_LOOKUPS,
+        TEXEL_FETCHES,
+        PIXELS_WRITTEN,
+        PIXELS_OVERWRITTEN,
+        COUNTER_COUNT
+    };
+
+    //! True if the counters are compiled in
+    static const bool ENABLED = RENDER_COUNTERS != 0;
+
+    uint64_t values[COUNTER_COUNT];
+
+    void reset() noexcept {
+        for (auto & value : values) {
+            value = 0;
+        }
+    }
+
+    void add(Counter counter, uint64_t count = 1) noexcept {
+        values[counter] += count;
+    }
+
+    //! Account a ray of a pass, which visited a number of cells
+    void addRay(Pass pass, int cells) noexcept {
+        ++values[RAYS + pass];
+        values[CELLS + pass] += cells;
+
+        if (pass == MAIN) {
+            int bucket = 0;
+
+            while (bucket < RAYS_OVER_128_CELLS - RAYS_UPTO_2_CELLS &&
+                cells > (2 << bucket))
+            {
+                ++bucket;
+            }
+
+            ++values[RAYS_UPTO_2_CELLS + bucket];
+        }
+    }
+
+    uint64_t get(int counter) const noexcept {
+        return values[counter];
+    }
+
+    //! Return the name of a counter, as in the CSV header
+    static const char* getName(int counter) noexcept;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+inline const char* RenderCounters::getName(int counter) noexcept
+{
+    static const char* const NAMES[COUNTER_COUNT] = {
+        "rays",
+        "transp_internal_rays",
+        "transp_external_rays",
+        "cells",
+        "transp_internal_cells",
+        "transp_external_cells",
+        "rays_upto_2_cells",
+        "rays_upto_4_cells",
+        "rays_upto_8_cells",
+        "rays_upto_16_cells",
+        "rays_upto_32_cells",
+        "rays_upto_64_cells",
+        "rays_upto_128_cells",
+        "rays_over_128_cells",
+        "ceiling_pixels",
+        "floor_pixels",
+        "wall_pixels",
+        "transp_pixels",
+        "transp_rejected",
+        "texture_lookups",
+        "texel_fetches",
+        "pixels_written",
+        "pixels_overwritten",
+    };
+
+    return counter >= 0 && counter < COUNTER_COUNT ? NAMES[counter] : "";
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif // __RENDERCOUNTERS_H__
@@ -0,0 +1,127 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "ResolutionScaler.h"
+
+
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+// Weight of the last frame in the average frame time
+const double SMOOTHING = 0.125;
+
+// The average must exceed the target by this ratio to drop resolution,
+// and the larger step must be expected below it to raise resolution
+const double DROP_RATIO = 1.05;
+const double RAISE_RATIO = 0.85;
+
+int alignRes(double res) noexcept
+{
+    const int aligned = int(res) & ~7;
+    return aligned < 8 ? 8 : aligned;
+}
+
+} // namespace
+
+
+/* -------------------------------------------------------------------------- */
+
+ResolutionScaler::ResolutionScaler(
+    int xProjRes,
+    int yProjRes,
+    double targetMs,
+    int stepCount,
+    double minScale) :
+    m_targetMs(targetMs)
+{
+    if (stepCount < 1) {
+        stepCount = 1;
+    }
+
+    m_steps.emplace_back(xProjRes, yProjRes);
+
+    for (int i = 1; i < stepCount; ++i) {
+        const double scale = 1.0 - (1.0 - minScale) * i / (stepCount - 1);
+        const std::pair<int, int> res(
+            alignRes(xProjRes * scale), alignRes(yProjRes * scale));
+
+        if (res != m_steps.back()) {
+            m_steps.push_back(res);
+        }
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void ResolutionScaler::prepare(Player& player) const
+{
+    for (const auto & step : m_steps) {
+        player.prepareProjRes(step.first);
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void ResolutionScaler::applyTo(Player& player) const
+{
+    player.setProjRes(getXProjRes(), getYProjRes());
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool ResolutionScaler::update(double frameMs) noexcept
+{
+    if (m_settle > 0) {
+        --m_settle;
+        return false;
+    }
+
+    m_average = m_samples ?
+        m_average + (frameMs - m_average) * SMOOTHING :
+        frameMs;
+
+    if (++m_samples < MIN_SAMPLES) {
+        return false;
+    }
+
+    // Frame time expected at a step
+    auto predict = [this](int step) {
+        return m_average * getPixels(step) / getPixels(m_step);
+    };
+
+    int step = m_step;
+
+    if (m_average > m_targetMs * DROP_RATIO) {
+        while (step + 1 < getStepCount() && predict(step) > m_targetMs) {
+            ++step;
+        }
+    }
+    else if (step > 0 && predict(step - 1) < m_targetMs * RAISE_RATIO) {
+        --step;
+    }
+
+    if (step == m_step) {
+        return false;
+    }
+
+    m_step = step;
+    m_samples = 0;
+    m_settle = SETTLE_FRAMES;
+    ++m_changeCount;
+
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
@@ -0,0 +1,117 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __RESOLUTIONSCALER_H__
+#define __RESOLUTIONSCALER_H__
+
+/* -------------------------------------------------------------------------- */
+
+#include "Player.h"
+
+#include <utility>
+#include <vector>
+
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Picks the projection resolution which holds a frame time target. The
+ * resolutions are a few steps from the full one down to a fraction of
+ * it; the frame times measured at a step, averaged, predict the time of
+ * the other ones (the cost of a frame is about proportional to its
+ * pixels). The scaler drops to the largest step expected to meet the
+ * target as soon as the average exceeds it, and raises the resolution one
+ * step at a time, only when the larger step is expected to leave some
+ * headroom. The frames presented are stretched to the window anyway
+ */
+class ResolutionScaler
+{
+public:
+    enum {
+        //! Frames averaged before changing step
+        MIN_SAMPLES = 8,
+
+        //! Frames ignored after a step change (e.g. textures being
+        //! loaded, buffers being reallocated)
+        SETTLE_FRAMES = 4
+    };
+
+    //! Create steps from xProjRes x yProjRes (step 0) down to minScale of
+    //! it, a multiple of 8 pixels in size
+    ResolutionScaler(
+        int xProjRes,
+        int yProjRes,
+        double targetMs,
+        int stepCount = 5,
+        double minScale = 0.5);
+
+    //! Build the player tables of all the steps, so that switching
+    //! between them is instant
+    void prepare(Player& player) const;
+
+    //! Set the player projection to the current step
+    void applyTo(Player& player) const;
+
+    //! Account the time of a frame rendered at the current step
+    //! @return true if the step changed (see applyTo)
+    bool update(double frameMs) noexcept;
+
+    int getStep() const noexcept {
+        return m_step;
+    }
+
+    int getStepCount() const noexcept {
+        return int(m_steps.size());
+    }
+
+    int getXProjRes() const noexcept {
+        return m_steps[m_step].first;
+    }
+
+    int getYProjRes() const noexcept {
+        return m_steps[m_step].second;
+    }
+
+    double getTarget() const noexcept {
+        return m_targetMs;
+    }
+
+    void setTarget(double targetMs) noexcept {
+        m_targetMs = targetMs;
+    }
+
+    //! Return the average frame time at the current step
+    double getAverage() const noexcept {
+        return m_average;
+    }
+
+    //! Return the number of step changes so far
+    size_t getChangeCount() const noexcept {
+        return m_changeCount;
+    }
+
+private:
+    double getPixels(int step) const noexcept {
+        return double(m_steps[step].first) * double(m_steps[step].second);
+    }
+
+    std::vector<std::pair<int, int>> m_steps;
+    double m_targetMs;
+    double m_average = 0;
+    int m_step = 0;
+    int m_samples = 0;
+    int m_settle = 0;
+    size_t m_changeCount = 0;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif // __RESOLUTIONSCALER_H__
@@ -0,0 +1,162 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "TextureCache.h"
+#include "TraceLog.h"
+#include "WorldMap.h"
+
+#include <chrono>
+
+
+/* -------------------------------------------------------------------------- */
+
+TextureCache::~TextureCache()
+{
+    for (auto & source : m_sources) {
+        if (source.job.valid()) {
+            source.job.wait();
+        }
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool TextureCache::add(int panelKey, const std::string& fileName, int dx, int dy)
+{
+    const int key = panelKey & 0xff;
+
+    if (m_state[key] != NO_IMAGE || dx < 1 || dy < 1) {
+        return false;
+    }
+
+    auto & placeholder = m_placeholders[std::make_pair(dx, dy)];
+
+    if (!placeholder) {
+        placeholder.reset(new Placeholder);
+        placeholder->pixels.assign(size_t(dx) * size_t(dy), 0x00808080);
+        placeholder->buffer.attach(placeholder->pixels.data(), dx, dy);
+    }
+
+    Source& source = m_sources[key];
+
+    source.fileName = fileName;
+    source.dx = dx;
+    source.dy = dy;
+
+    m_current[key] = &placeholder->buffer;
+    m_state[key] = ABSENT;
+
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+const BitmapBuffer* TextureCache::request(int key)
+{
+    Source& source = m_sources[key];
+
+    source.job = m_pool.submit([this, &source]() {
+        TraceScope scope("load", "texture", source.fileName.c_str());
+        std::unique_ptr<BitmapBuffer> image(new BitmapBuffer);
+
+        if (!image->load(source.fileName, source.dx, source.dy)) {
+            return false;
+        }
+
+        source.texture = m_registry.intern(std::move(image));
+
+        return true;
+    });
+
+    m_state[key] = LOADING;
+    ++m_loadingCount;
+
+    return m_current[key];
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void TextureCache::beginFrame()
+{
+    ++m_frame;
+
+    for (int key = 0; m_loadingCount > 0 && key < MAX_TEXTURES; ++key) {
+        Source& source = m_sources[key];
+
+        if (m_state[key] != LOADING ||
+            source.job.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            continue;
+        }
+
+        --m_loadingCount;
+        ++m_loadCount;
+
+        if (source.job.get()) {
+            m_current[key] = source.texture.get();
+            m_state[key] = RESIDENT;
+            ++m_residentCount;
+        }
+        else {
+            // The placeholder stays in place
+            m_state[key] = FAILED;
+        }
+    }
+
+    evict();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void TextureCache::evict()
+{
+    // Releasing a texture shared with other keys frees no memory, so
+    // the following ones are released as well
+    while (m_registry.getBytes() > m_budget) {
+        int lru = -1;
+
+        for (int key = 0; key < MAX_TEXTURES; ++key) {
+            if (m_state[key] == RESIDENT &&
+                m_lastUsed[key] + 1 < m_frame &&
+                (lru < 0 || m_lastUsed[key] < m_lastUsed[lru]))
+            {
+                lru = key;
+            }
+        }
+
+        if (lru < 0) {
+            break;
+        }
+
+        Source& source = m_sources[lru];
+
+        m_current[lru] = &m_placeholders[std::make_pair(source.dx, source.dy)]->buffer;
+        m_state[lru] = ABSENT;
+        --m_residentCount;
+        ++m_evictionCount;
+
+        source.texture.reset();
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void TextureCache::applyTo(WorldMap& wMap) noexcept
+{
+    wMap.setTextureCache(this);
+}
+
+
+/* -------------------------------------------------------------------------- */
@@ -0,0 +1,174 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __TEXTURECACHE_H__
+#define __TEXTURECACHE_H__
+
+/* -------------------------------------------------------------------------- */
+
+#include "BitmapBuffer.h"
+#include "TextureRegistry.h"
+#include "ThreadPool.h"
+
+#include <future>
+#include <map>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+/* -------------------------------------------------------------------------- */
+
+class WorldMap;
+
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Keeps resident only the textures the renderer actually samples, within
+ * a memory budget. A texture is decoded in background (on a thread pool)
+ * the first time it is fetched, and a placeholder of the same size is
+ * returned until it is ready. Each fetch records the current frame, so
+ * that at the beginning of a frame the least recently used textures are
+ * released while the resident ones exceed the budget; the textures used
+ * by the previous frame are never released, so the budget can be exceeded
+ * by a single frame which needs more than that. Identical images share
+ * a single buffer (see TextureRegistry), counted once in the budget
+ */
+class TextureCache
+{
+public:
+    enum { MAX_TEXTURES = 256 };
+
+    explicit TextureCache(
+        size_t budgetBytes,
+        ThreadPool& pool = ThreadPool::shared()) noexcept :
+        m_budget(budgetBytes),
+        m_pool(pool)
+    {}
+
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    ~TextureCache();
+
+    //! Set the image of a panel key, to be scaled to dx x dy pixels; it
+    //! is not loaded until the texture is fetched
+    //! @return false if the key already has an image
+    bool add(int panelKey, const std::string& fileName, int dx, int dy);
+
+    //! Return the texture of a panel key, or its placeholder while it is
+    //! not resident (nullptr if the key has no image); called by the
+    //! renderer thread
+    const BitmapBuffer* fetch(int panelKey) {
+        const int key = panelKey & 0xff;
+
+        m_lastUsed[key] = m_frame;
+
+        if (m_state[key] != ABSENT) {
+            return m_current[key];
+        }
+
+        return request(key);
+    }
+
+    //! Start a new frame: the textures decoded in the meantime become
+    //! resident and the least recently used ones exceeding the budget
+    //! are released; called by the renderer thread
+    void beginFrame();
+
+    //! Make the map fetch its textures from the cache, which must
+    //! outlive the map
+    void applyTo(WorldMap& wMap) noexcept;
+
+    size_t getBudget() const noexcept {
+        return m_budget;
+    }
+
+    void setBudget(size_t budgetBytes) noexcept {
+        m_budget = budgetBytes;
+    }
+
+    //! Return the memory used by the resident textures
+    size_t getResidentBytes() const {
+        return m_registry.getBytes();
+    }
+
+    size_t getResidentCount() const noexcept {
+        return m_residentCount;
+    }
+
+    //! Return the number of textures decoded so far (reloads included)
+    size_t getLoadCount() const noexcept {
+        return m_loadCount;
+    }
+
+    size_t getEvictionCount() const noexcept {
+        return m_evictionCount;
+    }
+
+    const TextureRegistry& getRegistry() const noexcept {
+        return m_registry;
+    }
+
+private:
+    enum State : uint8_t {
+        NO_IMAGE,
+        ABSENT,
+        LOADING,
+        RESIDENT,
+        FAILED
+    };
+
+    struct Source {
+        std::string fileName;
+        int dx = 0;
+        int dy = 0;
+        TextureRegistry::TexturePtr texture;
+        std::future<bool> job;
+    };
+
+    const BitmapBuffer* request(int key);
+    void evict();
+
+    // Fetched every pixel: the state of the keys is kept apart from the
+    // sources to keep it compact
+    uint64_t m_lastUsed[MAX_TEXTURES] = { 0 };
+    const BitmapBuffer* m_current[MAX_TEXTURES] = { 0 };
+    State m_state[MAX_TEXTURES] = { NO_IMAGE };
+    uint64_t m_frame = 1;
+
+    // Destroyed after the sources, which refer to its textures
+    TextureRegistry m_registry;
+    Source m_sources[MAX_TEXTURES];
+
+    // A placeholder per texture size (uniform grey)
+    struct Placeholder {
+        std::vector<DWORD> pixels;
+        BitmapBuffer buffer;
+    };
+
+    std::map<std::pair<int, int>, std::unique_ptr<Placeholder>> m_placeholders;
+
+    size_t m_budget;
+    size_t m_residentCount = 0;
+    size_t m_loadingCount = 0;
+    size_t m_loadCount = 0;
+    size_t m_evictionCount = 0;
+
+    ThreadPool& m_pool;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif // __TEXTURECACHE_H__
@@ -0,0 +1,138 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "TextureLoader.h"
+#include "TraceLog.h"
+#include "WorldMap.h"
+
+#include <new>
+
+
+/* -------------------------------------------------------------------------- */
+
+bool TextureLoader::add(int panelKey, const std::string& fileName, int dx, int dy)
+{
+    if (m_started) {
+        return false;
+    }
+
+    Texture texture;
+
+    texture.panelKey = panelKey;
+    texture.fileName = fileName;
+    texture.dx = dx;
+    texture.dy = dy;
+
+    m_textures.push_back(std::move(texture));
+
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void TextureLoader::start(ReadyHandler onReady)
+{
+    if (m_started) {
+        return;
+    }
+
+    m_onReady = std::move(onReady);
+    m_pending = m_textures.size();
+    m_started = true;
+
+    if (m_textures.empty()) {
+        if (m_onReady) {
+            m_onReady(true);
+        }
+
+        return;
+    }
+
+    // m_textures is not modified any more, so each job can refer
+    // to its own item
+    m_jobs.reserve(m_textures.size());
+
+    for (auto& texture : m_textures) {
+        m_jobs.push_back(m_pool.submit([this, &texture]() { decode(texture); }));
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void TextureLoader::decode(Texture& texture) noexcept
+{
+    TraceScope scope("load", "texture", texture.fileName.c_str());
+
+    try {
+        auto buffer = std::make_unique<BitmapBuffer>();
+
+        if (buffer->load(texture.fileName, texture.dx, texture.dy)) {
+            texture.buffer = m_registry.intern(std::move(buffer));
+            ++m_loaded;
+        }
+    }
+    catch (const std::bad_alloc&) {
+        texture.buffer.reset();
+    }
+
+    if (--m_pending == 0 && m_onReady) {
+        m_onReady(m_loaded == m_textures.size());
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool TextureLoader::wait()
+{
+    for (auto& job : m_jobs) {
+        if (job.valid()) {
+            job.wait();
+        }
+    }
+
+    return m_loaded == m_textures.size();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+std::vector<std::string> TextureLoader::getFailedFiles() const
+{
+    std::vector<std::string> files;
+
+    if (!isReady()) {
+        return files;
+    }
+
+    for (const auto& texture : m_textures) {
+        if (!texture.buffer) {
+            files.push_back(texture.fileName);
+        }
+    }
+
+    return files;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void TextureLoader::applyTo(WorldMap& wMap) const noexcept
+{
+    if (!isReady()) {
+        return;
+    }
+
+    for (const auto& texture : m_textures) {
+        wMap.applyTextureToPanel(texture.panelKey, texture.buffer.get());
+    }
+}
@@ -0,0 +1,121 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __TEXTURELOADER_H__
+#define __TEXTURELOADER_H__
+
+/* -------------------------------------------------------------------------- */
+
+#include "BitmapBuffer.h"
+#include "TextureRegistry.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+/* -------------------------------------------------------------------------- */
+
+class WorldMap;
+
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Decodes the texture images on a thread pool, straight into the pixel
+ * buffers used by the renderer, while the application goes on (e.g.
+ * creating the window or loading the map). The textures are owned by the
+ * loader, which must outlive the maps they are applied to; identical
+ * images share a single buffer (see TextureRegistry)
+ */
+class TextureLoader
+{
+public:
+    //! Called once all the textures have been processed, by the thread
+    //! which completed the last one; ok is false if any of them failed
+    using ReadyHandler = std::function<void(bool ok)>;
+
+    explicit TextureLoader(ThreadPool& pool = ThreadPool::shared()) noexcept :
+        m_pool(pool)
+    {}
+
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+
+    ~TextureLoader() {
+        wait();
+    }
+
+    //! Queue the image of a panel key, to be scaled to dx x dy pixels
+    //! @return false if the loading has already been started
+    bool add(int panelKey, const std::string& fileName, int dx, int dy);
+
+    //! Start decoding the queued images in background
+    void start(ReadyHandler onReady = nullptr);
+
+    //! Return true once all the queued images have been processed
+    bool isReady() const noexcept {
+        return m_started && m_pending == 0;
+    }
+
+    size_t getTextureCount() const noexcept {
+        return m_textures.size();
+    }
+
+    size_t getLoadedCount() const noexcept {
+        return m_loaded;
+    }
+
+    //! Wait for all the queued images (if started)
+    //! @return false if any of them could not be loaded
+    bool wait();
+
+    //! Return the files which could not be loaded (once ready)
+    std::vector<std::string> getFailedFiles() const;
+
+    //! Set the loaded textures to their panel keys (once ready)
+    void applyTo(WorldMap& wMap) const noexcept;
+
+    const TextureRegistry& getRegistry() const noexcept {
+        return m_registry;
+    }
+
+private:
+    struct Texture {
+        int panelKey = 0;
+        std::string fileName;
+        int dx = 0;
+        int dy = 0;
+        TextureRegistry::TexturePtr buffer;
+    };
+
+    void decode(Texture& texture) noexcept;
+
+    ThreadPool& m_pool;
+
+    // Destroyed after the textures, which refer to its buffers
+    TextureRegistry m_registry;
+    std::vector<Texture> m_textures;
+    std::vector<std::future<void>> m_jobs;
+    ReadyHandler m_onReady;
+
+    bool m_started = false;
+    std::atomic<size_t> m_pending{ 0 };
+    std::atomic<size_t> m_loaded{ 0 };
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif // __TEXTURELOADER_H__
@@ -0,0 +1,173 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "TextureRegistry.h"
+
+#include <string.h>
+#include <vector>
+
+
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+inline uint64_t mix(uint64_t h, uint64_t v) noexcept
+{
+    h ^= v;
+    h *= 0x9e3779b97f4a7c15ull;
+    return h ^ (h >> 32);
+}
+
+} // namespace
+
+
+/* -------------------------------------------------------------------------- */
+
+uint64_t TextureRegistry::hash(const BitmapBuffer& image) noexcept
+{
+    const uint8_t* p = (const uint8_t*)image.getPixels();
+    const size_t size = getBytes(image);
+
+    // Four independent lanes of 8 bytes, so that the multiplications
+    // of consecutive words overlap
+    uint64_t h[4] = {
+        uint64_t(image.getDx()),
+        uint64_t(image.getDy()),
+        0x243f6a8885a308d3ull,
+        0x13198a2e03707344ull
+    };
+
+    size_t i = 0;
+
+    for (; i + 32 <= size; i += 32) {
+        for (int lane = 0; lane < 4; ++lane) {
+            uint64_t v;
+            memcpy(&v, p + i + lane * 8, sizeof(v));
+            h[lane] = mix(h[lane], v);
+        }
+    }
+
+    for (; i < size; i += sizeof(DWORD)) {
+        DWORD v;
+        memcpy(&v, p + i, sizeof(v));
+        h[0] = mix(h[0], v);
+    }
+
+    return mix(mix(mix(h[0], h[1]), h[2]), h[3]);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool TextureRegistry::equal(const BitmapBuffer& a, const BitmapBuffer& b) noexcept
+{
+    return a.getDx() == b.getDx() && a.getDy() == b.getDy() &&
+        memcmp(a.getPixels(), b.getPixels(), getBytes(a)) == 0;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+TextureRegistry::TexturePtr TextureRegistry::intern(std::unique_ptr<BitmapBuffer> image)
+{
+    if (!image) {
+        return nullptr;
+    }
+
+    const uint64_t key = hash(*image);
+
+    // The reference is created before locking the registry: if it is
+    // not registered (a duplicate or an allocation failure), its release
+    // just deletes the image
+    TexturePtr texture(image.get(), [this, key](const BitmapBuffer* image) {
+        release(image, key);
+    });
+
+    image.release();
+
+    // References to the textures compared are dropped once the registry
+    // is unlocked, as one of them could be the last one
+    std::vector<TexturePtr> candidates;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto range = m_textures.equal_range(key);
+
+    for (auto it = range.first; it != range.second; ++it) {
+        // An expired entry is being released by another thread
+        TexturePtr registered = it->second.ref.lock();
+
+        if (registered && equal(*registered, *texture)) {
+            ++m_sharedCount;
+            return registered;
+        }
+
+        if (registered) {
+            candidates.push_back(std::move(registered));
+        }
+    }
+
+    m_textures.emplace(key, Entry{ texture.get(), texture });
+    m_bytes += getBytes(*texture);
+
+    return texture;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void TextureRegistry::release(const BitmapBuffer* image, uint64_t key) noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto range = m_textures.equal_range(key);
+
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second.image == image) {
+                m_bytes -= getBytes(*image);
+                m_textures.erase(it);
+                break;
+            }
+        }
+    }
+
+    delete image;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+size_t TextureRegistry::getTextureCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_textures.size();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+size_t TextureRegistry::getBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_bytes;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+size_t TextureRegistry::getSharedCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_sharedCount;
+}
+
+
+/* -------------------------------------------------------------------------- */
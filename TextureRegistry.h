@@ -0,0 +1,85 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __TEXTUREREGISTRY_H__
+#define __TEXTUREREGISTRY_H__
+
+/* -------------------------------------------------------------------------- */
+
+#include "BitmapBuffer.h"
+
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <unordered_map>
+
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Shares a single buffer among the textures having the same pixels (e.g.
+ * panel keys or tmap entries referring to identical images). Decoded
+ * images are registered by a hash of their content: an image equal to a
+ * registered one is dropped and the existing buffer is returned instead.
+ * Buffers are reference counted, and leave the registry when the last
+ * reference is released. It can be used by many threads at once, and
+ * must outlive the textures it returns
+ */
+class TextureRegistry
+{
+public:
+    using TexturePtr = std::shared_ptr<const BitmapBuffer>;
+
+    TextureRegistry() = default;
+
+    TextureRegistry(const TextureRegistry&) = delete;
+    TextureRegistry& operator=(const TextureRegistry&) = delete;
+
+    //! Return the registered texture with the same size and pixels of
+    //! image, or register image if there is none
+    TexturePtr intern(std::unique_ptr<BitmapBuffer> image);
+
+    //! Return the number of distinct textures
+    size_t getTextureCount() const;
+
+    //! Return the memory used by the distinct textures
+    size_t getBytes() const;
+
+    //! Return the number of images found equal to a registered one
+    size_t getSharedCount() const;
+
+    //! Return a hash of the size and of the pixels of an image
+    static uint64_t hash(const BitmapBuffer& image) noexcept;
+
+    //! Return true if two images have the same size and pixels
+    static bool equal(const BitmapBuffer& a, const BitmapBuffer& b) noexcept;
+
+private:
+    struct Entry {
+        const BitmapBuffer* image;
+        std::weak_ptr<const BitmapBuffer> ref;
+    };
+
+    void release(const BitmapBuffer* image, uint64_t key) noexcept;
+
+    static size_t getBytes(const BitmapBuffer& image) noexcept {
+        return size_t(image.getDx()) * size_t(image.getDy()) * sizeof(DWORD);
+    }
+
+    mutable std::mutex m_mutex;
+    std::unordered_multimap<uint64_t, Entry> m_textures;
+    size_t m_bytes = 0;
+    size_t m_sharedCount = 0;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif // __TEXTUREREGISTRY_H__
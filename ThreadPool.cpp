@@ -0,0 +1,143 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "ThreadPool.h"
+#include "TraceLog.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+
+
+/* -------------------------------------------------------------------------- */
+
+ThreadPool::ThreadPool(size_t threadCount)
+{
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+
+    if (threadCount == 0) {
+        threadCount = 1;
+    }
+
+    m_workers.reserve(threadCount);
+
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_workers.emplace_back([this, i]() {
+            TraceLog::shared().setThreadName("worker " + std::to_string(i));
+            run();
+        });
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_stop = true;
+    }
+
+    m_cv.notify_all();
+
+    for (auto & worker : m_workers) {
+        worker.join();
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+ThreadPool& ThreadPool::shared()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void ThreadPool::enqueue(std::function<void()>&& job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_jobs.push_back(std::move(job));
+    }
+
+    m_cv.notify_one();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void ThreadPool::run()
+{
+    for (;;) {
+        std::function<void()> job;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mtx);
+
+            m_cv.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+
+            // Pending jobs are completed before leaving
+            if (m_jobs.empty()) {
+                return;
+            }
+
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        job();
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& fn)
+{
+    struct State {
+        std::atomic<size_t> next{ 0 };
+        std::atomic<size_t> done{ 0 };
+        std::mutex mtx;
+        std::condition_variable cv;
+    };
+
+    auto state = std::make_shared<State>();
+
+    // Helpers which start late find no index left and return: fn is
+    // only used while some call is pending, so it is still alive
+    auto work = [state, &fn, count]() {
+        for (size_t i = state->next++; i < count; i = state->next++) {
+            fn(i);
+
+            if (++state->done == count) {
+                std::lock_guard<std::mutex> lock(state->mtx);
+                state->cv.notify_all();
+            }
+        }
+    };
+
+    const size_t helpers = std::min(count ? count - 1 : 0, m_workers.size());
+
+    for (size_t i = 0; i < helpers; ++i) {
+        enqueue(work);
+    }
+
+    work();
+
+    std::unique_lock<std::mutex> lock(state->mtx);
+    state->cv.wait(lock, [&state, count]() { return state->done == count; });
+}
@@ -0,0 +1,85 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __THREADPOOL_H__
+#define __THREADPOOL_H__
+
+/* -------------------------------------------------------------------------- */
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+/* -------------------------------------------------------------------------- */
+
+//! Fixed set of worker threads running queued tasks
+class ThreadPool
+{
+public:
+    //! Create a pool of given number of workers (0 means one per core)
+    explicit ThreadPool(size_t threadCount = 0);
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool();
+
+    //! Pool shared by the engine components
+    static ThreadPool& shared();
+
+    size_t getThreadCount() const noexcept {
+        return m_workers.size();
+    }
+
+    //! Queue a task, the returned future gives its result
+    template<class F>
+    auto submit(F&& task) -> std::future<typename std::invoke_result<F>::type> {
+        using Result = typename std::invoke_result<F>::type;
+
+        auto job = std::make_shared<std::packaged_task<Result()>>(
+            std::forward<F>(task));
+
+        auto result = job->get_future();
+
+        enqueue([job]() { (*job)(); });
+
+        return result;
+    }
+
+    /**
+     * Run fn(i) for i in [0, count) on the pool workers and on the 
+     * calling thread, returning when all the calls are done. 
+     * The calling thread takes part in the work, so this can be used
+     * from a task already running on the pool
+     */
+    void parallelFor(size_t count, const std::function<void(size_t)>& fn);
+
+private:
+    void enqueue(std::function<void()>&& job);
+    void run();
+
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_jobs;
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    bool m_stop = false;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif // __THREADPOOL_H__
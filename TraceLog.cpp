@@ -0,0 +1,269 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "TraceLog.h"
+
+#include <fstream>
+#include <stdio.h>
+#include <string.h>
+
+
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+// Buffer of the calling thread in the shared log
+thread_local void* threadBuffer = nullptr;
+
+
+/* -------------------------------------------------------------------------- */
+
+// Write a string as a JSON string literal
+void writeString(std::ostream& os, const char* s)
+{
+    os << '"';
+
+    for (; *s; ++s) {
+        const unsigned char c = (unsigned char)*s;
+
+        if (c == '"' || c == '\\') {
+            os << '\\' << char(c);
+        }
+        else if (c < 0x20) {
+            char code[8];
+            snprintf(code, sizeof(code), "\\u%04x", c);
+            os << code;
+        }
+        else {
+            os << char(c);
+        }
+    }
+
+    os << '"';
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+// Write nanoseconds as microseconds, the Chrome trace time unit
+void writeTime(std::ostream& os, int64_t ns)
+{
+    char text[32];
+    snprintf(text, sizeof(text), "%lld.%03d",
+        (long long)(ns / 1000), int(ns % 1000));
+
+    os << text;
+}
+
+} // namespace
+
+
+/* -------------------------------------------------------------------------- */
+
+TraceLog::TraceLog() :
+    m_epoch(Clock::now())
+{}
+
+
+/* -------------------------------------------------------------------------- */
+
+TraceLog& TraceLog::shared()
+{
+    // Never destroyed: threads may trace until the process ends
+    static TraceLog* log = new TraceLog;
+    return *log;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+TraceLog::Buffer& TraceLog::getBuffer()
+{
+    if (!threadBuffer) {
+        std::lock_guard<std::mutex> lock(m_mtx);
+
+        m_buffers.emplace_back(new Buffer);
+        m_buffers.back()->id = int(m_buffers.size());
+
+        threadBuffer = m_buffers.back().get();
+    }
+
+    return *static_cast<Buffer*>(threadBuffer);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void TraceLog::complete(
+    const char* category,
+    const char* name,
+    int64_t begin,
+    int64_t end,
+    const char* detail) noexcept
+{
+    Buffer& buffer = getBuffer();
+
+    // Only this thread increments the count
+    const size_t count = buffer.count.load(std::memory_order_relaxed);
+
+    if (count == buffer.events.size()) {
+        try {
+            if (count == 0) {
+                buffer.events.resize(BUFFER_EVENTS);
+            }
+        }
+        catch (const std::bad_alloc&) {
+        }
+
+        if (count == buffer.events.size()) {
+            buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    Event& event = buffer.events[count];
+
+    event.category = category;
+    event.name = name;
+    event.begin = begin;
+    event.duration = end - begin;
+    event.detail[0] = 0;
+
+    if (detail) {
+        strncpy(event.detail, detail, DETAIL_SIZE - 1);
+        event.detail[DETAIL_SIZE - 1] = 0;
+    }
+
+    // The log has been cleared while the event was being written
+    size_t expected = count;
+
+    if (!buffer.count.compare_exchange_strong(
+        expected, count + 1, std::memory_order_release, std::memory_order_relaxed))
+    {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void TraceLog::clear() noexcept
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+
+    for (const auto& buffer : m_buffers) {
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->dropped.store(0, std::memory_order_relaxed);
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void TraceLog::setThreadName(const std::string& name)
+{
+    Buffer& buffer = getBuffer();
+
+    std::lock_guard<std::mutex> lock(m_mtx);
+    buffer.name = name;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+size_t TraceLog::getEventCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    size_t count = 0;
+
+    for (const auto& buffer : m_buffers) {
+        count += buffer->count.load(std::memory_order_acquire);
+    }
+
+    return count;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+size_t TraceLog::getDroppedCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+    size_t count = 0;
+
+    for (const auto& buffer : m_buffers) {
+        count += buffer->dropped.load(std::memory_order_relaxed);
+    }
+
+    return count;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool TraceLog::write(std::ostream& os) const
+{
+    std::lock_guard<std::mutex> lock(m_mtx);
+
+    os << "{\"traceEvents\":[\n";
+    os << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+        "\"args\":{\"name\":\"WinRayCast\"}}";
+
+    for (const auto& buffer : m_buffers) {
+        if (!buffer->name.empty()) {
+            os << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+                << buffer->id << ",\"args\":{\"name\":";
+            writeString(os, buffer->name.c_str());
+            os << "}}";
+        }
+
+        // Events below the count are complete and no longer written
+        const size_t count = buffer->count.load(std::memory_order_acquire);
+
+        for (size_t i = 0; i < count; ++i) {
+            const Event& event = buffer->events[i];
+
+            os << ",\n{\"name\":";
+            writeString(os, event.name);
+            os << ",\"cat\":";
+            writeString(os, event.category);
+            os << ",\"ph\":\"X\",\"ts\":";
+            writeTime(os, event.begin);
+            os << ",\"dur\":";
+            writeTime(os, event.duration);
+            os << ",\"pid\":1,\"tid\":" << buffer->id;
+
+            if (event.detail[0]) {
+                os << ",\"args\":{\"detail\":";
+                writeString(os, event.detail);
+                os << "}";
+            }
+
+            os << "}";
+        }
+    }
+
+    os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    return bool(os);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool TraceLog::write(const std::string& fileName) const
+{
+    std::ofstream os(fileName);
+
+    return os.is_open() && write(os) && bool(os.flush());
+}
+
+
+/* -------------------------------------------------------------------------- */
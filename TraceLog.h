@@ -0,0 +1,171 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __TRACELOG_H__
+#define __TRACELOG_H__
+
+/* -------------------------------------------------------------------------- */
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Records timed slices of work (frames and their stages, texture and map
+ * loading, frame presentation) of all the threads of the process, to be
+ * written as a Chrome trace (JSON) which can be opened by Perfetto or
+ * chrome://tracing. Each thread appends to a buffer of its own, without
+ * locks: a thread takes the log mutex only the first time it traces.
+ * Buffers have a fixed capacity, the events which do not fit are dropped
+ * until the log is cleared. When the log is disabled, tracing a slice costs a flag test
+ */
+class TraceLog
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum {
+        //! Events kept per thread, at most
+        BUFFER_EVENTS = 32768,
+
+        //! Characters of the detail of an event (see complete)
+        DETAIL_SIZE = 32
+    };
+
+    //! Log shared by the whole process
+    static TraceLog& shared();
+
+    TraceLog(const TraceLog&) = delete;
+    TraceLog& operator=(const TraceLog&) = delete;
+
+    bool isEnabled() const noexcept {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    //! Start or stop tracing (the events recorded are kept)
+    void setEnabled(bool enabled) noexcept {
+        m_enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    //! Return the time elapsed since the log was created, in nanoseconds
+    int64_t now() const noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now() - m_epoch).count();
+    }
+
+    //! Record a slice of the calling thread from begin to end (see now).
+    //! name and category must be string literals, detail (e.g. a file
+    //! name) is copied and truncated to DETAIL_SIZE - 1 characters
+    void complete(
+        const char* category,
+        const char* name,
+        int64_t begin,
+        int64_t end,
+        const char* detail = nullptr) noexcept;
+
+    //! Record a slice from a mark to now, and return now (the mark of the
+    //! next slice)
+    int64_t lap(const char* category, const char* name, int64_t mark) noexcept {
+        const int64_t end = now();
+        complete(category, name, mark, end);
+        return end;
+    }
+
+    //! Discard the events recorded and dropped so far, to start a new
+    //! trace. To be called while the log is disabled: a slice which a
+    //! thread is still completing is dropped
+    void clear() noexcept;
+
+    //! Name the calling thread in the trace
+    void setThreadName(const std::string& name);
+
+    //! Return the number of events recorded and dropped, in all threads
+    size_t getEventCount() const;
+    size_t getDroppedCount() const;
+
+    //! Write the events recorded so far as a Chrome trace. It can be
+    //! called while other threads are tracing
+    bool write(std::ostream& os) const;
+    bool write(const std::string& fileName) const;
+
+private:
+    struct Event {
+        const char* category;
+        const char* name;
+        int64_t begin;
+        int64_t duration;
+        char detail[DETAIL_SIZE];
+    };
+
+    // Events are written by the owner thread only, and published by
+    // updating their count (which clear may reset meanwhile)
+    struct Buffer {
+        int id = 0;
+        std::string name;
+        std::vector<Event> events;
+        std::atomic<size_t> count{ 0 };
+        std::atomic<size_t> dropped{ 0 };
+    };
+
+    TraceLog();
+
+    Buffer& getBuffer();
+
+    const Clock::time_point m_epoch;
+    std::atomic<bool> m_enabled{ false };
+
+    mutable std::mutex m_mtx;
+    std::vector<std::unique_ptr<Buffer>> m_buffers;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+//! Records a slice of the calling thread from its construction to its
+//! destruction, if the shared log is enabled at construction
+class TraceScope
+{
+public:
+    TraceScope(const char* category, const char* name, const char* detail = nullptr) noexcept :
+        m_category(category),
+        m_name(name),
+        m_detail(detail),
+        m_begin(TraceLog::shared().isEnabled() ? TraceLog::shared().now() : -1)
+    {}
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    ~TraceScope() {
+        if (m_begin >= 0) {
+            TraceLog& log = TraceLog::shared();
+            log.complete(m_category, m_name, m_begin, log.now(), m_detail);
+        }
+    }
+
+private:
+    const char* m_category;
+    const char* m_name;
+    const char* m_detail;
+    int64_t m_begin;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif // __TRACELOG_H__
@@ -0,0 +1,375 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "Upscaler.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define UPSCALER_SSE2
+#include <emmintrin.h>
+#endif
+
+
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+// Replicate each of count pixels factor (1 ... 4) times
+void replicate(const DWORD* src, int count, int factor, DWORD* dst) noexcept
+{
+    if (factor == 1) {
+        memcpy(dst, src, size_t(count) * sizeof(DWORD));
+        return;
+    }
+
+    int i = 0;
+
+#ifdef UPSCALER_SSE2
+    switch (factor) {
+    case 2:
+        for (; i + 4 <= count; i += 4, dst += 8) {
+            const __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+            _mm_storeu_si128((__m128i*)dst, _mm_unpacklo_epi32(v, v));
+            _mm_storeu_si128((__m128i*)(dst + 4), _mm_unpackhi_epi32(v, v));
+        }
+        break;
+
+    case 3:
+        for (; i + 4 <= count; i += 4, dst += 12) {
+            const __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+            _mm_storeu_si128((__m128i*)dst,
+                _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 0, 0)));
+            _mm_storeu_si128((__m128i*)(dst + 4),
+                _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 2, 1, 1)));
+            _mm_storeu_si128((__m128i*)(dst + 8),
+                _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 2)));
+        }
+        break;
+
+    case 4:
+        for (; i + 4 <= count; i += 4, dst += 16) {
+            const __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+            _mm_storeu_si128((__m128i*)dst,
+                _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 0, 0, 0)));
+            _mm_storeu_si128((__m128i*)(dst + 4),
+                _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 1, 1, 1)));
+            _mm_storeu_si128((__m128i*)(dst + 8),
+                _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 2, 2, 2)));
+            _mm_storeu_si128((__m128i*)(dst + 12),
+                _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 3)));
+        }
+        break;
+
+    default:
+        break;
+    }
+#endif
+
+    for (; i < count; ++i) {
+        for (int k = 0; k < factor; ++k) {
+            *dst++ = src[i];
+        }
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+// Interpolate two pixels, w (0 ... 127) being the weight of b in 128ths
+inline DWORD lerp(DWORD a, DWORD b, int w) noexcept
+{
+    const DWORD rb =
+        (((a & 0xff00ff) * DWORD(128 - w) + (b & 0xff00ff) * DWORD(w)) >> 7) & 0xff00ff;
+
+    const DWORD g =
+        (((a & 0x00ff00) * DWORD(128 - w) + (b & 0x00ff00) * DWORD(w)) >> 7) & 0x00ff00;
+
+    return rb | g;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifdef UPSCALER_SSE2
+
+// Interpolate four pairs of pixels, wlo and whi being the weights of the
+// channels of the first and of the last two pixels of b:
+// a + (b - a) * w / 128 on 16 bit channels, as |b - a| * w < 2^15
+inline __m128i lerp4(__m128i a, __m128i b, __m128i wlo, __m128i whi) noexcept
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    const __m128i alo = _mm_unpacklo_epi8(a, zero);
+    const __m128i ahi = _mm_unpackhi_epi8(a, zero);
+
+    const __m128i dlo = _mm_srai_epi16(_mm_mullo_epi16(
+        _mm_sub_epi16(_mm_unpacklo_epi8(b, zero), alo), wlo), 7);
+
+    const __m128i dhi = _mm_srai_epi16(_mm_mullo_epi16(
+        _mm_sub_epi16(_mm_unpackhi_epi8(b, zero), ahi), whi), 7);
+
+    return _mm_packus_epi16(_mm_add_epi16(alo, dlo), _mm_add_epi16(ahi, dhi));
+}
+
+#endif
+
+
+/* -------------------------------------------------------------------------- */
+
+// Interpolate count pixels of two rows, with the same weight
+void blend(const DWORD* a, const DWORD* b, int count, int w, DWORD* dst) noexcept
+{
+    int i = 0;
+
+#ifdef UPSCALER_SSE2
+    const __m128i weight = _mm_set1_epi16(short(w));
+
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128((__m128i*)(dst + i), lerp4(
+            _mm_loadu_si128((const __m128i*)(a + i)),
+            _mm_loadu_si128((const __m128i*)(b + i)),
+            weight, weight));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        dst[i] = lerp(a[i], b[i], w);
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+// Interpolate the pixels of a row at count positions, each one given by
+// a column, the next one (the same at the right edge) and a weight of
+// the latter, repeated for its 4 channels
+void resample(
+    const DWORD* src,
+    const int* cols, const int* next, const int16_t* weights,
+    int count, DWORD* dst) noexcept
+{
+    int i = 0;
+
+#ifdef UPSCALER_SSE2
+    for (; i + 4 <= count; i += 4) {
+        const __m128i a = _mm_set_epi32(
+            int(src[cols[i + 3]]), int(src[cols[i + 2]]),
+            int(src[cols[i + 1]]), int(src[cols[i]]));
+
+        const __m128i b = _mm_set_epi32(
+            int(src[next[i + 3]]), int(src[next[i + 2]]),
+            int(src[next[i + 1]]), int(src[next[i]]));
+
+        _mm_storeu_si128((__m128i*)(dst + i), lerp4(a, b,
+            _mm_loadu_si128((const __m128i*)(weights + 4 * i)),
+            _mm_loadu_si128((const __m128i*)(weights + 4 * i + 8))));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        dst[i] = lerp(src[cols[i]], src[next[i]], weights[4 * i]);
+    }
+}
+
+} // namespace
+
+
+/* -------------------------------------------------------------------------- */
+
+bool Upscaler::hasSimd() noexcept
+{
+#ifdef UPSCALER_SSE2
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void Upscaler::scale(
+    const Frame& src,
+    DWORD* dst, int dstWidth, int dstHeight, int dstPitch,
+    Filter filter)
+{
+    if (src.width <= 0 || src.height <= 0 || dstWidth <= 0 || dstHeight <= 0) {
+        return;
+    }
+
+    if (filter == Filter::BILINEAR) {
+        bilinear(src, dst, dstWidth, dstHeight, dstPitch);
+    }
+    else {
+        nearest(src, dst, dstWidth, dstHeight, dstPitch);
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void Upscaler::nearest(
+    const Frame& src,
+    DWORD* dst, int dstWidth, int dstHeight, int dstPitch)
+{
+    const int factor = dstWidth % src.width == 0 ? dstWidth / src.width : 0;
+
+    // Any other ratio samples the source column at the center of the
+    // output one
+    if (factor < 1 || factor > 4) {
+        m_cols.resize(dstWidth);
+
+        for (int x = 0; x < dstWidth; ++x) {
+            m_cols[x] = int((int64_t(2 * x + 1) * src.width) / (2 * int64_t(dstWidth)));
+        }
+    }
+
+    int lastRow = -1;
+
+    for (int y = 0; y < dstHeight; ++y) {
+        const int row = int((int64_t(2 * y + 1) * src.height) / (2 * int64_t(dstHeight)));
+        DWORD* out = dst + size_t(y) * size_t(dstPitch);
+
+        if (row == lastRow) {
+            memcpy(out, out - dstPitch, size_t(dstWidth) * sizeof(DWORD));
+            continue;
+        }
+
+        const DWORD* in = src.pixels + size_t(row) * size_t(src.pitch);
+
+        if (factor >= 1 && factor <= 4) {
+            replicate(in, src.width, factor, out);
+        }
+        else {
+            for (int x = 0; x < dstWidth; ++x) {
+                out[x] = in[m_cols[x]];
+            }
+        }
+
+        lastRow = row;
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void Upscaler::bilinear(
+    const Frame& src,
+    DWORD* dst, int dstWidth, int dstHeight, int dstPitch)
+{
+    // Source position (16.16 fixed point) of the center of an output
+    // pixel, split into a pixel and a 7 bit weight of the next one
+    auto locate = [](int i, int srcSize, int dstSize, int& weight) {
+        int64_t pos = ((int64_t(2 * i + 1) * srcSize << 16) / (2 * int64_t(dstSize))) - 0x8000;
+
+        if (pos < 0) {
+            pos = 0;
+        }
+
+        int index = int(pos >> 16);
+        weight = int(pos >> 9) & 127;
+
+        if (index >= srcSize - 1) {
+            index = srcSize - 1;
+            weight = 0;
+        }
+
+        return index;
+    };
+
+    m_cols.resize(dstWidth);
+    m_next.resize(dstWidth);
+    m_weights.resize(4 * size_t(dstWidth));
+
+    for (int x = 0; x < dstWidth; ++x) {
+        int w;
+
+        m_cols[x] = locate(x, src.width, dstWidth, w);
+        m_next[x] = w ? m_cols[x] + 1 : m_cols[x];
+
+        for (int channel = 0; channel < 4; ++channel) {
+            m_weights[4 * size_t(x) + channel] = int16_t(w);
+        }
+    }
+
+    // Source rows scaled horizontally, the even ones in the first half
+    // of m_rows, the odd ones in the second one
+    m_rows.resize(2 * size_t(dstWidth));
+
+    int scaledRow[2] = { -1, -1 };
+
+    auto getRow = [&](int row) {
+        DWORD* out = m_rows.data() + size_t(row & 1) * size_t(dstWidth);
+
+        if (scaledRow[row & 1] != row) {
+            resample(src.pixels + size_t(row) * size_t(src.pitch),
+                m_cols.data(), m_next.data(), m_weights.data(), dstWidth, out);
+
+            scaledRow[row & 1] = row;
+        }
+
+        return out;
+    };
+
+    for (int y = 0; y < dstHeight; ++y) {
+        int w;
+        const int row = locate(y, src.height, dstHeight, w);
+        DWORD* out = dst + size_t(y) * size_t(dstPitch);
+
+        if (w) {
+            const DWORD* a = getRow(row);
+            const DWORD* b = getRow(row + 1);
+
+            blend(a, b, dstWidth, w, out);
+        }
+        else {
+            memcpy(out, getRow(row), size_t(dstWidth) * sizeof(DWORD));
+        }
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool ScalingFrameSink::present(const Frame& frame)
+{
+    int width, height;
+    Upscaler::Filter filter;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+
+        width = m_width;
+        height = m_height;
+        filter = m_filter;
+    }
+
+    if (width <= 0 || height <= 0 ||
+        (width == frame.width && height == frame.height))
+    {
+        return m_target.present(frame);
+    }
+
+    // Scale straight into the target buffer, if it provides one
+    DWORD* pixels = m_target.acquire(width, height);
+
+    if (!pixels) {
+        m_pixels.resize(size_t(width) * size_t(height));
+        pixels = m_pixels.data();
+    }
+
+    m_upscaler.scale(frame, pixels, width, height, width, filter);
+
+    return m_target.present(Frame{ pixels, width, height, width });
+}
+
+
+/* -------------------------------------------------------------------------- */
@@ -0,0 +1,111 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __UPSCALER_H__
+#define __UPSCALER_H__
+
+/* -------------------------------------------------------------------------- */
+
+#include "FrameSink.h"
+
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Scales frames to the size of the window, so that the display only has
+ * to copy them. Nearest-neighbour scaling replicates each source pixel
+ * 2, 3 or 4 times by means of SIMD kernels when the horizontal ratio is
+ * an integer (any other ratio uses a column table); rows are replicated
+ * by copying an already scaled one. Bilinear scaling interpolates the
+ * columns of each source row once, then blends two such rows per output
+ * row, both with SIMD kernels. Pixels are 32 bit BGRX (see Frame)
+ */
+class Upscaler
+{
+public:
+    enum class Filter {
+        NEAREST,
+        BILINEAR
+    };
+
+    //! Scale src to dstWidth x dstHeight pixels at dst, the first pixels
+    //! of two rows being dstPitch pixels apart
+    void scale(
+        const Frame& src,
+        DWORD* dst, int dstWidth, int dstHeight, int dstPitch,
+        Filter filter);
+
+    //! Return true if the SIMD kernels are compiled in
+    static bool hasSimd() noexcept;
+
+private:
+    void nearest(const Frame& src, DWORD* dst, int dstWidth, int dstHeight, int dstPitch);
+    void bilinear(const Frame& src, DWORD* dst, int dstWidth, int dstHeight, int dstPitch);
+
+    // Source column, next column and 7 bit weight of the latter (per
+    // channel), per output column
+    std::vector<int> m_cols;
+    std::vector<int> m_next;
+    std::vector<int16_t> m_weights;
+
+    // Source rows scaled horizontally (bilinear)
+    std::vector<DWORD> m_rows;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+//! Upscales the frames to an output size and presents them to another
+//! sink, into the buffer it provides (see FrameSink::acquire) if any
+class ScalingFrameSink : public FrameSink
+{
+public:
+    //! target must outlive this sink
+    ScalingFrameSink(FrameSink& target, Upscaler::Filter filter = Upscaler::Filter::NEAREST) :
+        m_target(target),
+        m_filter(filter)
+    {}
+
+    //! Set the size of the frames presented to the target (0 means the
+    //! size of the frames received: no scaling). It can be called by a
+    //! thread other than the one presenting (see AsyncFrameSink)
+    void setOutputSize(int width, int height, Upscaler::Filter filter) {
+        std::lock_guard<std::mutex> lock(m_mtx);
+
+        m_width = width;
+        m_height = height;
+        m_filter = filter;
+    }
+
+    bool ready() const noexcept override {
+        return m_target.ready();
+    }
+
+    bool present(const Frame& frame) override;
+
+private:
+    FrameSink& m_target;
+    Upscaler m_upscaler;
+    std::vector<DWORD> m_pixels;
+
+    std::mutex m_mtx;
+    int m_width = 0;
+    int m_height = 0;
+    Upscaler::Filter m_filter;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif // __UPSCALER_H__
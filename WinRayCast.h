@@ -1,19 +1,19 @@
-// This file is part of the WinRayCast Application (a 3D Engine Demo).
-// Copyright (C) 2005 - 2018
-// Antonino Calderone (antonino.calderone@gmail.com)
-// All rights reserved.  
-// Licensed under the MIT License. 
-// See COPYING file in the project root for full license information.
-
-
-#if !defined(AFX_WINRAYCAST_H__F2EDDB7A_B46A_442D_A720_D338F0DC1341__INCLUDED_)
-#define AFX_WINRAYCAST_H__F2EDDB7A_B46A_442D_A720_D338F0DC1341__INCLUDED_
-
-#if _MSC_VER > 1000
-#pragma once
-#endif // _MSC_VER > 1000
-
-#include "resource.h"
-
-
-#endif // !defined(AFX_WINRAYCAST_H__F2EDDB7A_B46A_442D_A720_D338F0DC1341__INCLUDED_)
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+#if !defined(AFX_WINRAYCAST_H__F2EDDB7A_B46A_442D_A720_D338F0DC1341__INCLUDED_)
+#define AFX_WINRAYCAST_H__F2EDDB7A_B46A_442D_A720_D338F0DC1341__INCLUDED_
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+#include "resource.h"
+
+
+#endif // !defined(AFX_WINRAYCAST_H__F2EDDB7A_B46A_442D_A720_D338F0DC1341__INCLUDED_)
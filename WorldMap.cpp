@@ -1,203 +1,893 @@
-// This file is part of the WinRayCast Application (a 3D Engine Demo).
-// Copyright (C) 2005 - 2018
-// Antonino Calderone (antonino.calderone@gmail.com)
-// All rights reserved.  
-// Licensed under the MIT License. 
-// See COPYING file in the project root for full license information.
-
-
-/* -------------------------------------------------------------------------- */
-
-#include "WorldMap.h"
-
-#include <fstream>
-
-#include "./miptknzr/include/mip_unicode.h"
-#include "./miptknzr/include/mip_tknzr_bldr.h"
-#include "./miptknzr/include/mip_esc_cnvrtr.h"
-
-#include <iostream>
-
-
-/* -------------------------------------------------------------------------- */
-
-bool WorldMap::setMapInfo(const Cell* array, uint32_t rows, uint32_t cols)
-{
-    if (rows <= 0 || cols <= 0) {
-        return false;
-    }
-
-    m_map.resize(rows);
-
-    int i = 0;
-
-    for (uint32_t r = 0; r < rows; ++r) {
-        m_map[r].resize(cols);
-
-        for (uint32_t c = 0; c < cols; ++c) {
-            m_map[r][c] = array[i++];
-        }
-    }
-
-    m_maxX = getCellDx() * getColCount();
-    m_maxY = getCellDy() * getRowCount();
-
-    return true; // success
-}
-
-
-/* -------------------------------------------------------------------------- */
-
-bool WorldMap::load(const std::string& fileName)
-{
-    mip::tknzr_bldr_t bldr;
-
-    bldr.def_atom(_T("{"));
-    bldr.def_atom(_T("}"));
-    bldr.def_atom(_T(","));
-
-    bldr.def_sl_comment(_T("//"));
-    bldr.def_sl_comment(_T("#"));
-    bldr.def_blank(_T(" "));
-    bldr.def_blank(_T("\r")); // treat \r like a blank
-    bldr.def_blank(_T("\t"));
-
-    bldr.def_eol(mip::base_tknzr_t::eol_t::LF); // linefeed is end of line marker
-
-    bldr.def_string(_T('\"'), std::make_shared<mip::esc_cnvrtr_t>(_T('\\')));
-
-    bldr.def_ml_comment(_T("/*"), _T("*/"));
-
-    auto tknzr = bldr.build();
-
-    mip::_ifstream is(fileName, std::ios::in | std::ios::binary);
-
-    if (!is.is_open()) {
-        return false;
-    }
-
-    enum state_t {
-        ANY_KEY,
-        MAP_BEGIN,
-        MAP_VAL,
-        TEXTURE_BEGIN,
-        TEXTURE_KEY,
-        TEXTURE_VALUE
-    };
-
-    state_t st = ANY_KEY;
-    std::vector<uint64_t> mapValues;
-    std::map<std::string, std::string> textureMap;
-    std::string txtKey;
-
-    int cols = -1;
-    int rows = 0;
-    int offset = 0;
-
-    using tcl_t = mip::token_t::tcl_t;
-
-    while (is.is_open() && !is.bad()) {
-        auto tkn = tknzr->next(is);
-
-        if (!tkn) {
-            return false;
-        }
-
-        switch (tkn->type()) {
-            case mip::token_t::tcl_t::END_OF_FILE: {
-                setMapInfo(mapValues.data(), rows, cols);
-            }
-            return true;
-
-            case mip::token_t::tcl_t::BLANK:
-            case mip::token_t::tcl_t::COMMENT:
-            case mip::token_t::tcl_t::END_OF_LINE:
-                break;
-            
-            case mip::token_t::tcl_t::ATOM:
-            case mip::token_t::tcl_t::STRING:
-            case mip::token_t::tcl_t::OTHER: {
-                switch (st) {
-                    case MAP_BEGIN:
-                        if (tkn->type() == tcl_t::ATOM && tkn->value() == "{") {
-                            st = MAP_VAL;
-                            break;
-                        }
-                        return false;
-                    case ANY_KEY:
-                        if (tkn->type()==tcl_t::OTHER && tkn->value() == "map") {
-                            st = MAP_BEGIN;
-                            break;
-                        }
-                        else if (tkn->type() == tcl_t::OTHER && tkn->value() == "tmap") {
-                            st = TEXTURE_BEGIN;
-                            break;
-                        }
-                        return false;
-                    case MAP_VAL:
-                        if (tkn->type() == tcl_t::ATOM) {
-                            if (tkn->value() == ",") {
-                                if (cols < 0) {
-                                    cols = offset;
-                                }
-                                else {
-                                    if (cols != offset) {
-                                        return false;
-                                    }
-                                }
-
-                                offset = 0;
-                                ++rows;
-                            }
-                            else if (tkn->value() == "}") {
-                                st = ANY_KEY;
-                                ++rows;
-                                break;
-                            }
-                        }
-                        else if (tkn->type() == tcl_t::OTHER) {
-                            try {
-                                mapValues.push_back(
-                                    std::stoll(tkn->value(), 0, 16));
-                                ++offset;
-                            }
-                            catch (...) {
-                                return false;
-                            }
-                        }
-                        break;
-                    case TEXTURE_BEGIN:
-                        if (tkn->type() == tcl_t::ATOM && tkn->value() == "{") {
-                            st = TEXTURE_KEY;
-                        }
-                        break;
-                    case TEXTURE_KEY:
-                        if (tkn->type() == tcl_t::OTHER) {
-                            st = TEXTURE_VALUE;
-                            txtKey = tkn->value();
-                        }
-                        else if (tkn->type() == tcl_t::ATOM && tkn->value() == "}") {
-                            st = ANY_KEY;
-                        }
-                        else {
-                            return false;
-                        }
-                        break;
-                    case TEXTURE_VALUE:
-                        if (tkn->type() == tcl_t::STRING) {
-                            st = TEXTURE_KEY;
-                            m_textureList[txtKey] = tkn->value();
-                        }
-                        else {
-                            return false;
-                        }
-                        break;
-                } // switch st
-            }
-            break;
-        }
-    } // while
-
-    return false;
-}
-
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "WorldMap.h"
+#include "ThreadPool.h"
+#include "TraceLog.h"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WORLDMAP_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "./miptknzr/include/mip_unicode.h"
+#include "./miptknzr/include/mip_tknzr_bldr.h"
+#include "./miptknzr/include/mip_esc_cnvrtr.h"
+#include "./miptknzr/include/mip_mmap_file.h"
+
+#include <iostream>
+
+
+/* -------------------------------------------------------------------------- */
+
+bool WorldMap::setMapInfo(const Cell* array, uint32_t rows, uint32_t cols)
+{
+    if (rows <= 0 || cols <= 0) {
+        return false;
+    }
+
+    return setMapInfo(
+        std::vector<Cell>(array, array + size_t(rows) * cols), rows, cols);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool WorldMap::setMapInfo(std::vector<Cell>&& cells, uint32_t rows, uint32_t cols)
+{
+    if (rows <= 0 || cols <= 0 || cells.size() < size_t(rows) * cols) {
+        return false;
+    }
+
+    cells.resize(size_t(rows) * cols);
+
+    m_cells = std::move(cells);
+    m_rows = int(rows);
+    m_cols = int(cols);
+
+    m_maxX = getCellDx() * getColCount();
+    m_maxY = getCellDy() * getRowCount();
+
+    return true; // success
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool WorldMap::loadBinary(const char* data, size_t size)
+{
+    BinaryHeader hdr;
+
+    if (size < sizeof(hdr)) {
+        return false;
+    }
+
+    memcpy(&hdr, data, sizeof(hdr));
+
+    if (memcmp(hdr.magic, binaryMagic(), sizeof(hdr.magic)) != 0) {
+        return false;
+    }
+
+    const char* pos = data + sizeof(hdr);
+    const char* end = data + size;
+
+    const size_t cellCount = size_t(hdr.rows) * size_t(hdr.cols);
+
+    if (cellCount == 0 || size_t(end - pos) / sizeof(Cell) < cellCount) {
+        return false;
+    }
+
+    // The cells are copied, as the data may not be aligned for them
+    const char* cells = pos;
+    pos += cellCount * sizeof(Cell);
+
+    auto readString = [&pos, end](std::string& str) {
+        uint32_t len = 0;
+
+        if (size_t(end - pos) < sizeof(len)) {
+            return false;
+        }
+
+        memcpy(&len, pos, sizeof(len));
+        pos += sizeof(len);
+
+        if (size_t(end - pos) < len) {
+            return false;
+        }
+
+        str.assign(pos, len);
+        pos += len;
+
+        return true;
+    };
+
+    // The map is left as it is unless the whole file is valid
+    TextureList textures;
+
+    for (uint32_t i = 0; i < hdr.textures; ++i) {
+        std::string key, value;
+
+        if (!readString(key) || !readString(value)) {
+            return false;
+        }
+
+        textures[key] = value;
+    }
+
+    std::vector<Cell> cellVector(cellCount);
+    memcpy(cellVector.data(), cells, cellCount * sizeof(Cell));
+
+    if (!setMapInfo(std::move(cellVector), hdr.rows, hdr.cols)) {
+        return false;
+    }
+
+    for (auto& item : textures) {
+        m_textureList[item.first] = std::move(item.second);
+    }
+
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool WorldMap::saveBinary(const std::string& fileName) const
+{
+    std::ofstream os(fileName, std::ios::out | std::ios::binary);
+
+    if (!os.is_open()) {
+        return false;
+    }
+
+    return saveBinary(os);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool WorldMap::saveBinary(std::ostream& os) const
+{
+    BinaryHeader hdr = { { 0 } };
+
+    memcpy(hdr.magic, binaryMagic(), sizeof(hdr.magic));
+    hdr.rows = getRowCount();
+    hdr.cols = getColCount();
+    hdr.textures = uint32_t(m_textureList.size());
+
+    os.write((const char*)&hdr, sizeof(hdr));
+
+    os.write((const char*)m_cells.data(), m_cells.size() * sizeof(Cell));
+
+    auto writeString = [&os](const std::string& str) {
+        const uint32_t len = uint32_t(str.size());
+        os.write((const char*)&len, sizeof(len));
+        os.write(str.data(), len);
+    };
+
+    for (const auto & item : m_textureList) {
+        writeString(item.first);
+        writeString(item.second);
+    }
+
+    return bool(os);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+// Classes of the characters the map block fast path cares about
+enum CharClass : uint8_t {
+    CH_OTHER,
+    CH_BLANK,
+    CH_EOL,
+    CH_COMMA,
+    CH_END,
+    CH_SLASH,
+    CH_HASH,
+    CH_QUOTE,
+    CH_BEGIN
+};
+
+struct CharClassTable {
+    uint8_t cls[256] = { 0 };
+
+    CharClassTable() noexcept {
+        cls[uint8_t(' ')] = CH_BLANK;
+        cls[uint8_t('\t')] = CH_BLANK;
+        cls[uint8_t('\r')] = CH_BLANK;
+        cls[uint8_t('\n')] = CH_EOL;
+        cls[uint8_t(',')] = CH_COMMA;
+        cls[uint8_t('}')] = CH_END;
+        cls[uint8_t('/')] = CH_SLASH;
+        cls[uint8_t('#')] = CH_HASH;
+        cls[uint8_t('"')] = CH_QUOTE;
+        cls[uint8_t('{')] = CH_BEGIN;
+    }
+
+    uint8_t operator[](char ch) const noexcept {
+        return cls[uint8_t(ch)];
+    }
+};
+
+const CharClassTable s_charClass;
+
+
+/* -------------------------------------------------------------------------- */
+
+// Return true if a comment ("//", "#" or "/*") begins at pos
+inline bool isComment(const char* pos, const char* end) noexcept
+{
+    const auto cl = s_charClass[*pos];
+
+    return cl == CH_HASH ||
+        (cl == CH_SLASH && pos + 1 < end && (pos[1] == '/' || pos[1] == '*'));
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+// Skip the comment at pos, keeping line count, and return the position
+// which follows it (the end of line for single-line comments) or nullptr
+// if a multi-line comment is not terminated
+const char* skipComment(
+    const char* pos,
+    const char* end,
+    size_t& line,
+    const char*& lineBegin) noexcept
+{
+    if (*pos == '#' || pos[1] == '/') {
+        const char* eol = (const char*)memchr(pos, '\n', size_t(end - pos));
+        return eol ? eol : end;
+    }
+
+    for (pos += 2; pos + 1 < end; ++pos) {
+        if (*pos == '\n') {
+            ++line;
+            lineBegin = pos + 1;
+        }
+        else if (pos[0] == '*' && pos[1] == '/') {
+            return pos + 2;
+        }
+    }
+
+    return nullptr;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+// Return true if a cell token ends at pos
+inline bool isCellEnd(const char* pos, const char* end) noexcept
+{
+    const auto cl = s_charClass[*pos];
+    return cl != CH_OTHER && (cl != CH_SLASH || isComment(pos, end));
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+// Generic cell decoder: up to 16 hex digits, optional 0x prefix
+inline bool decodeCell(const char* begin, const char* end, WorldMap::Cell& value) noexcept
+{
+    if (end - begin > 2 && begin[0] == '0' && (begin[1] | 0x20) == 'x') {
+        begin += 2;
+    }
+
+    const auto res = std::from_chars(begin, end, value, 16);
+
+    return res.ec == std::errc() && res.ptr == end;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifdef WORLDMAP_SSE2
+
+// Return the index of the lowest bit set (mask must be non-zero)
+inline unsigned firstBit(unsigned mask) noexcept
+{
+#ifdef _MSC_VER
+    unsigned long index = 0;
+    _BitScanForward(&index, mask);
+    return unsigned(index);
+#else
+    return unsigned(__builtin_ctz(mask));
+#endif
+}
+
+#endif
+
+
+/* -------------------------------------------------------------------------- */
+
+// Skip cell and blank characters, return the position of the first
+// character of any other class (or end)
+inline const char* skipPlain(const char* pos, const char* end) noexcept
+{
+#ifdef WORLDMAP_SSE2
+    for (; end - pos >= 16; pos += 16) {
+        const __m128i text = _mm_loadu_si128((const __m128i*)pos);
+
+        __m128i special = _mm_cmpeq_epi8(text, _mm_set1_epi8('\n'));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(text, _mm_set1_epi8(',')));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(text, _mm_set1_epi8('}')));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(text, _mm_set1_epi8('/')));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(text, _mm_set1_epi8('#')));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(text, _mm_set1_epi8('"')));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(text, _mm_set1_epi8('{')));
+
+        const unsigned mask = unsigned(_mm_movemask_epi8(special));
+
+        if (mask) {
+            return pos + firstBit(mask);
+        }
+    }
+#endif
+
+    while (pos < end && s_charClass[*pos] <= CH_BLANK) {
+        ++pos;
+    }
+
+    return pos;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifdef WORLDMAP_SSE2
+
+// Decode a cell made of exactly ten hex digits (the map file format):
+// the 16 bytes at pos must be readable. Return the length of the run of
+// hex digits which begins at pos; value is set only if such length is 10
+inline int decodeCell10(const char* pos, WorldMap::Cell& value) noexcept
+{
+    const __m128i text = _mm_loadu_si128((const __m128i*)pos);
+
+    const __m128i digit = _mm_sub_epi8(text, _mm_set1_epi8('0'));
+    const __m128i letter = _mm_sub_epi8(
+        _mm_or_si128(text, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+
+    const __m128i isDigit =
+        _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    const __m128i isLetter =
+        _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+
+    const unsigned notHex =
+        ~unsigned(_mm_movemask_epi8(_mm_or_si128(isDigit, isLetter)));
+
+    const unsigned len = firstBit(notHex);
+
+    if (len != 10) {
+        return int(len);
+    }
+
+    // Nibbles, then bytes made of nibble pairs (most significant first)
+    const __m128i nibble = _mm_or_si128(
+        _mm_and_si128(isDigit, digit),
+        _mm_andnot_si128(isDigit, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+
+    const __m128i pairs = _mm_and_si128(
+        _mm_or_si128(_mm_slli_epi16(nibble, 4), _mm_srli_epi16(nibble, 8)),
+        _mm_set1_epi16(0xff));
+
+    uint64_t bytes = 0;
+    _mm_storel_epi64((__m128i*)&bytes, _mm_packus_epi16(pairs, pairs));
+
+#ifdef _MSC_VER
+    value = _byteswap_uint64(bytes) >> 24;
+#else
+    value = __builtin_bswap64(bytes) >> 24;
+#endif
+
+    return 10;
+}
+
+#endif
+
+
+/* -------------------------------------------------------------------------- */
+
+// Tokenizer definitions of map files: built once, shared by all the loads
+mip::tknzr_def_ptr_t mapTknzrDef()
+{
+    static const mip::tknzr_def_ptr_t def = []() {
+        mip::tknzr_bldr_t bldr;
+
+        bldr.def_atom(_T("{"));
+        bldr.def_atom(_T("}"));
+        bldr.def_atom(_T(","));
+
+        bldr.def_sl_comment(_T("//"));
+        bldr.def_sl_comment(_T("#"));
+        bldr.def_blank(_T(" "));
+        bldr.def_blank(_T("\r")); // treat \r like a blank
+        bldr.def_blank(_T("\t"));
+
+        bldr.def_eol(mip::base_tknzr_t::eol_t::LF); // linefeed is end of line marker
+
+        bldr.def_string(_T('\"'), std::make_shared<mip::esc_cnvrtr_t>(_T('\\')));
+
+        bldr.def_ml_comment(_T("/*"), _T("*/"));
+
+        return bldr.build_def();
+    }();
+
+    return def;
+}
+
+} // namespace
+
+
+/* -------------------------------------------------------------------------- */
+
+std::string WorldMap::formatError(size_t line, size_t col, const std::string& what)
+{
+    return 
+        "line " + std::to_string(line + 1) + 
+        ", column " + std::to_string(col + 1) + ": " + what;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool WorldMap::setError(size_t line, size_t col, const std::string& what)
+{
+    m_lastError = formatError(line, col, what);
+    return false;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool WorldMap::scanMapBlock(
+    const char*& pos,
+    const char* end,
+    size_t& line,
+    const char*& lineBegin,
+    std::vector<RowSpan>& spans)
+{
+    RowSpan span = { pos, nullptr, lineBegin, line };
+
+    while (pos < end) {
+        switch (s_charClass[*pos]) {
+            case CH_OTHER:
+            case CH_BLANK:
+                pos = skipPlain(pos + 1, end);
+                break;
+
+            case CH_EOL:
+                ++line;
+                lineBegin = ++pos;
+                break;
+
+            case CH_COMMA:
+                span.end = pos++;
+                spans.push_back(span);
+                span = { pos, nullptr, lineBegin, line };
+                break;
+
+            case CH_END:
+                span.end = pos++;
+                spans.push_back(span);
+                return true;
+
+            case CH_SLASH:
+            case CH_HASH:
+                if (!isComment(pos, end)) {
+                    ++pos;
+                }
+                else {
+                    const char* commentBegin = pos;
+                    const size_t commentLine = line;
+                    const char* commentLineBegin = lineBegin;
+
+                    pos = skipComment(pos, end, line, lineBegin);
+
+                    if (!pos) {
+                        return setError(
+                            commentLine, size_t(commentBegin - commentLineBegin),
+                            "unterminated comment");
+                    }
+                }
+                break;
+
+            default:
+                return setError(
+                    line, size_t(pos - lineBegin),
+                    std::string("unexpected '") + *pos + "' in map");
+        }
+    }
+
+    return setError(line, size_t(pos - lineBegin), "missing '}' at end of map");
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool WorldMap::decodeMapRow(
+    const RowSpan& span,
+    const char* textEnd,
+    Cell* cells,
+    size_t maxCells,
+    size_t& count,
+    std::string& error)
+{
+    const char* pos = span.begin;
+    const char* lineBegin = span.lineBegin;
+    size_t line = span.line;
+
+    count = 0;
+
+    while (pos < span.end) {
+        const auto cl = s_charClass[*pos];
+
+        if (cl == CH_BLANK) {
+            ++pos;
+            continue;
+        }
+
+        if (cl == CH_EOL) {
+            ++line;
+            lineBegin = ++pos;
+            continue;
+        }
+
+        if (isComment(pos, span.end)) {
+            // comments have already been validated by scanMapBlock()
+            pos = skipComment(pos, span.end, line, lineBegin);
+            continue;
+        }
+
+        if (count == maxCells) {
+            error = formatError(
+                line, size_t(pos - lineBegin),
+                "too many cells in row (expected " + 
+                std::to_string(maxCells) + ")");
+
+            return false;
+        }
+
+        const char* tokenEnd = nullptr;
+
+#ifdef WORLDMAP_SSE2
+        if (textEnd - pos >= 16 &&
+            decodeCell10(pos, cells[count]) == 10 &&
+            isCellEnd(pos + 10, textEnd))
+        {
+            pos += 10;
+            ++count;
+            continue;
+        }
+#endif
+
+        for (tokenEnd = pos + 1; tokenEnd < span.end; ++tokenEnd) {
+            if (isCellEnd(tokenEnd, span.end)) {
+                break;
+            }
+        }
+
+        if (!decodeCell(pos, tokenEnd, cells[count])) {
+            error = formatError(
+                line, size_t(pos - lineBegin),
+                "malformed cell '" + std::string(pos, tokenEnd) + "'");
+
+            return false;
+        }
+
+        pos = tokenEnd;
+        ++count;
+    }
+
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool WorldMap::decodeMapRows(
+    const RowSpan* spans,
+    size_t rowCount,
+    const char* textEnd,
+    Cell* cells,
+    size_t cols,
+    std::string& error)
+{
+    for (size_t r = 0; r < rowCount; ++r, cells += cols) {
+        const auto& span = spans[r];
+        size_t count = 0;
+
+        if (!decodeMapRow(span, textEnd, cells, cols, count, error)) {
+            return false;
+        }
+
+        if (count != cols) {
+            error = formatError(
+                span.line, size_t(span.begin - span.lineBegin),
+                "row has " + std::to_string(count) + 
+                " cells instead of " + std::to_string(cols));
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool WorldMap::loadMapBlock(
+    const char*& pos,
+    const char* end,
+    size_t line,
+    const char* lineBegin,
+    std::vector<Cell>& cells,
+    int& rows,
+    int& cols)
+{
+    // First pass: find the row boundaries
+    std::vector<RowSpan> spans;
+
+    if (!scanMapBlock(pos, end, line, lineBegin, spans)) {
+        return false;
+    }
+
+    std::vector<Cell> firstRow;
+    size_t r = 0;
+    size_t count = 0;
+
+    // The first row gives the column count of the map
+    if (cols < 0) {
+        const auto& span = spans[0];
+
+        firstRow.resize(size_t(span.end - span.begin) / 2 + 1);
+
+        if (!decodeMapRow(
+            span, end, firstRow.data(), firstRow.size(), count, m_lastError)) 
+        {
+            return false;
+        }
+
+        firstRow.resize(count);
+        cols = int(count);
+        r = 1;
+    }
+
+    // A separator which ends the last row is tolerated
+    size_t spanCount = spans.size();
+    std::string error;
+
+    if (spanCount > 1 && 
+        decodeMapRow(spans.back(), end, nullptr, 0, count, error)) 
+    {
+        --spanCount;
+    }
+
+    // Second pass: decode the rows straight into their place in the map
+    const size_t base = cells.size();
+
+    cells.resize(base + spanCount * size_t(cols));
+    std::copy(firstRow.begin(), firstRow.end(), cells.begin() + base);
+
+    if (r < spanCount) {
+        // Large maps are split in blocks of rows decoded in parallel
+        const size_t bytes = size_t(spans[spanCount - 1].end - spans[r].begin);
+        const size_t rowCount = spanCount - r;
+
+        auto& pool = ThreadPool::shared();
+
+        const size_t blockCount = std::min(
+            rowCount,
+            std::min(pool.getThreadCount() * 4, bytes / MIN_BLOCK_BYTES + 1));
+
+        std::vector<std::string> errors(blockCount);
+        std::vector<char> failed(blockCount, 0);
+
+        auto decodeBlock = [&](size_t b) {
+            TraceScope scope("load", "map rows");
+
+            const size_t first = r + rowCount * b / blockCount;
+            const size_t last = r + rowCount * (b + 1) / blockCount;
+
+            failed[b] = !decodeMapRows(
+                &spans[first],
+                last - first,
+                end,
+                cells.data() + base + first * size_t(cols),
+                size_t(cols),
+                errors[b]);
+        };
+
+        if (blockCount > 1) {
+            pool.parallelFor(blockCount, decodeBlock);
+        }
+        else {
+            decodeBlock(0);
+        }
+
+        // Report the error found first in the text
+        for (size_t b = 0; b < blockCount; ++b) {
+            if (failed[b]) {
+                m_lastError = errors[b];
+                return false;
+            }
+        }
+    }
+
+    rows += int(spanCount);
+
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool WorldMap::load(const std::string& fileName)
+{
+    TraceScope scope("load", "map file", fileName.c_str());
+
+    m_lastError.clear();
+
+    mip::mmap_file_t file;
+
+    if (!file.open(fileName)) {
+        m_lastError = "cannot open " + fileName;
+        return false;
+    }
+
+    return load(file.data(), file.size());
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool WorldMap::load(const char* data, size_t size)
+{
+    TraceScope scope("load", "map parse");
+
+    m_lastError.clear();
+
+    if (size >= sizeof(BinaryHeader) &&
+        memcmp(data, binaryMagic(), sizeof(BinaryHeader::magic)) == 0)
+    {
+        if (!loadBinary(data, size)) {
+            m_lastError = "invalid binary map";
+            return false;
+        }
+
+        return true;
+    }
+
+    mip::buf_tknzr_t tknzr(mapTknzrDef());
+
+    tknzr.reset(mip::string_view_t(data, size));
+
+    enum state_t {
+        ANY_KEY,
+        MAP_BEGIN,
+        TEXTURE_BEGIN,
+        TEXTURE_KEY,
+        TEXTURE_VALUE
+    };
+
+    state_t st = ANY_KEY;
+    std::vector<Cell> cells;
+    std::string txtKey;
+    std::string txtValue;
+
+    int cols = -1;
+    int rows = 0;
+
+    using tcl_t = mip::token_t::tcl_t;
+
+    mip::token_view_t tkn;
+
+    while (tknzr.next(tkn)) {
+        switch (tkn.type()) {
+            case mip::token_t::tcl_t::END_OF_FILE: {
+                setMapInfo(std::move(cells), rows, cols);
+            }
+            return true;
+
+            case mip::token_t::tcl_t::BLANK:
+            case mip::token_t::tcl_t::COMMENT:
+            case mip::token_t::tcl_t::END_OF_LINE:
+                break;
+            
+            case mip::token_t::tcl_t::ATOM:
+            case mip::token_t::tcl_t::STRING:
+            case mip::token_t::tcl_t::OTHER: {
+                switch (st) {
+                    case MAP_BEGIN:
+                        if (tkn.type() == tcl_t::ATOM && tkn.value() == "{") {
+                            // The map block is decoded by a dedicated fast
+                            // path, then tokenization goes on after it
+                            const char* pos = tkn.value().data() + 1;
+                            const char* lineBegin = 
+                                tkn.value().data() - tkn.offset();
+
+                            if (!loadMapBlock(
+                                pos, 
+                                data + size,
+                                tkn.line(),
+                                lineBegin,
+                                cells,
+                                rows,
+                                cols)) 
+                            {
+                                return false;
+                            }
+
+                            tknzr.skip(pos);
+                            st = ANY_KEY;
+                            break;
+                        }
+                        return setError(tkn.line(), tkn.offset(), "'{' expected");
+                    case ANY_KEY:
+                        if (tkn.type()==tcl_t::OTHER && tkn.value() == "map") {
+                            st = MAP_BEGIN;
+                            break;
+                        }
+                        else if (tkn.type() == tcl_t::OTHER && tkn.value() == "tmap") {
+                            st = TEXTURE_BEGIN;
+                            break;
+                        }
+                        return setError(tkn.line(), tkn.offset(), 
+                            "unexpected '" + std::string(tkn.value()) + "'");
+                    case TEXTURE_BEGIN:
+                        if (tkn.type() == tcl_t::ATOM && tkn.value() == "{") {
+                            st = TEXTURE_KEY;
+                        }
+                        break;
+                    case TEXTURE_KEY:
+                        if (tkn.type() == tcl_t::OTHER) {
+                            st = TEXTURE_VALUE;
+                            txtKey = tkn.value();
+                        }
+                        else if (tkn.type() == tcl_t::ATOM && tkn.value() == "}") {
+                            st = ANY_KEY;
+                        }
+                        else {
+                            return setError(tkn.line(), tkn.offset(), 
+                                "texture key expected");
+                        }
+                        break;
+                    case TEXTURE_VALUE:
+                        if (tkn.type() == tcl_t::STRING &&
+                            tknzr.unescape(tkn, txtValue))
+                        {
+                            st = TEXTURE_KEY;
+                            m_textureList[txtKey] = txtValue;
+                        }
+                        else {
+                            return setError(tkn.line(), tkn.offset(), 
+                                "texture file name expected");
+                        }
+                        break;
+                } // switch st
+            }
+            break;
+        }
+    } // while
+
+    return false;
+}
+
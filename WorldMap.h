@@ -1,131 +1,222 @@
-// This file is part of the WinRayCast Application (a 3D Engine Demo).
-// Copyright (C) 2005 - 2018
-// Antonino Calderone (antonino.calderone@gmail.com)
-// All rights reserved.  
-// Licensed under the MIT License. 
-// See COPYING file in the project root for full license information.
-
-
-/* -------------------------------------------------------------------------- */
-
-#ifndef __WORLDMAP_H__
-#define __WORLDMAP_H__
-
-#include "BitmapBuffer.h"
-#include "Player.h"
-
-#include <windows.h>
-#pragma warning (disable: 4786)
-#include <math.h>
-#include <map>
-#include <vector>
-#include <string>
-
-/* -------------------------------------------------------------------------- */
-
-class WorldMap
-{
-public:
-    using Cell = uint64_t;
-    using Point2d = std::pair<double, double>;
-    using TextureList = std::map<std::string, std::string>;
-
-    WorldMap() = default;
-
-    HBITMAP getBmp(int key) const noexcept { 
-        return m_bmp[key]; 
-    }
-
-    const Point2d& getPlayerCellPos() const noexcept { 
-        return m_playerCellPos; 
-    }
-
-    int getRowCount() const noexcept { 
-        return int(m_map.size()); 
-    }
-
-    int getColCount() const noexcept { 
-        return int(m_map.empty() ? 0 : m_map[0].size()); 
-    }
-
-    uint32_t getCellDx() const noexcept { 
-        return m_cellDx; 
-    }
-
-    uint32_t getCellDy() const noexcept { 
-        return m_cellDy; 
-    }
-
-    std::vector<Cell> & operator[](uint32_t index) throw () { 
-        return m_map[index]; 
-    }
-
-    const std::vector<Cell> & operator[](uint32_t index) const throw () {
-        return m_map[index];
-    }
-
-
-    void resizeCell(uint32_t cellDx, uint32_t cellDy) noexcept {
-        m_cellDx = cellDx;
-        m_cellDy = cellDy;
-        m_maxX = getCellDx() * getColCount();
-        m_maxY = getCellDy() * getRowCount();
-    }
-
-    void setPlayerPos(int x, int y) noexcept {
-        m_playerCellPos.first = /*player.getX()*/ x / getCellDx();
-        m_playerCellPos.second = /*player.getY()*/ y / getCellDy();
-    }
-
-    void applyTextureToPanel(int panelKey, HBITMAP hBitmap) noexcept {
-        m_bmp[panelKey & 0xff] = hBitmap;
-    }
-
-    int getMaxX() const noexcept { 
-        return m_maxX; 
-    }
-
-    int getMaxY() const noexcept { 
-        return m_maxY; 
-    }
-
-    void set(int row, int col, Cell cellVal) {
-        if (col < getColCount() && row < getRowCount())
-            m_map[row][col] = cellVal;
-    }
-
-    bool load(const std::string& fileName);
-
-    const TextureList& getTextureList() const noexcept {
-        return m_textureList;
-    }
-
-    TextureList& getTextureList() noexcept {
-        return m_textureList;
-    }
-
-private:
-    bool setMapInfo(const Cell* array, uint32_t rows, uint32_t cols);
-
-    using Row = std::vector<Cell>;
-    using Matrix = std::vector<Row>;
-
-    Matrix m_map;
-
-    int m_cellDx = 256;
-    int m_cellDy = 256;
-
-    int m_maxX = 0;
-    int m_maxY = 0;
-
-    Point2d m_playerCellPos{ 0,0 };
-
-    HBITMAP m_bmp[256] = { 0 };
-
-    TextureList m_textureList;
-};
-
-
-/* -------------------------------------------------------------------------- */
-
-#endif
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __WORLDMAP_H__
+#define __WORLDMAP_H__
+
+#include "BitmapBuffer.h"
+#include "Player.h"
+#include "TextureCache.h"
+
+#include "PlatformTypes.h"
+
+#include <math.h>
+#include <map>
+#include <ostream>
+#include <vector>
+#include <string>
+
+/* -------------------------------------------------------------------------- */
+
+class WorldMap
+{
+public:
+    using Cell = uint64_t;
+    using Point2d = std::pair<double, double>;
+    using TextureList = std::map<std::string, std::string>;
+
+    //! Header of the binary map format: it is followed by rows*cols
+    //! little-endian cells and by 'textures' tmap entries, each of them
+    //! stored as <uint32 length, key chars, uint32 length, value chars>
+    struct BinaryHeader {
+        char magic[8];
+        uint32_t rows;
+        uint32_t cols;
+        uint32_t textures;
+        uint32_t reserved;
+    };
+
+    static const char* binaryMagic() noexcept {
+        return "WRCMAP01";
+    }
+
+    WorldMap() = default;
+
+    //! Return the texture of a panel key (nullptr if not loaded)
+    const BitmapBuffer* getTexture(int key) const { 
+        if (m_textureCache) {
+            return m_textureCache->fetch(key);
+        }
+
+        return m_texture[key & 0xff]; 
+    }
+
+    const Point2d& getPlayerCellPos() const noexcept { 
+        return m_playerCellPos; 
+    }
+
+    int getRowCount() const noexcept { 
+        return m_rows; 
+    }
+
+    int getColCount() const noexcept { 
+        return m_cols; 
+    }
+
+    uint32_t getCellDx() const noexcept { 
+        return m_cellDx; 
+    }
+
+    uint32_t getCellDy() const noexcept { 
+        return m_cellDy; 
+    }
+
+    Cell* operator[](uint32_t index) throw () { 
+        return m_cells.data() + size_t(index) * m_cols; 
+    }
+
+    const Cell* operator[](uint32_t index) const throw () {
+        return m_cells.data() + size_t(index) * m_cols;
+    }
+
+
+    void resizeCell(uint32_t cellDx, uint32_t cellDy) noexcept {
+        m_cellDx = cellDx;
+        m_cellDy = cellDy;
+        m_maxX = getCellDx() * getColCount();
+        m_maxY = getCellDy() * getRowCount();
+    }
+
+    void setPlayerPos(int x, int y) noexcept {
+        m_playerCellPos.first = /*player.getX()*/ x / getCellDx();
+        m_playerCellPos.second = /*player.getY()*/ y / getCellDy();
+    }
+
+    void applyTextureToPanel(int panelKey, const BitmapBuffer* texture) noexcept {
+        m_texture[panelKey & 0xff] = texture;
+    }
+
+    //! Fetch the textures from a cache (nullptr to use the panel ones)
+    void setTextureCache(TextureCache* cache) noexcept {
+        m_textureCache = cache;
+    }
+
+    int getMaxX() const noexcept { 
+        return m_maxX; 
+    }
+
+    int getMaxY() const noexcept { 
+        return m_maxY; 
+    }
+
+    void set(int row, int col, Cell cellVal) {
+        if (col < getColCount() && row < getRowCount())
+            (*this)[row][col] = cellVal;
+    }
+
+    bool load(const std::string& fileName);
+
+    //! Load a map (text or binary format) from memory
+    bool load(const char* data, size_t size);
+
+    bool saveBinary(const std::string& fileName) const;
+    bool saveBinary(std::ostream& os) const;
+
+    //! Return a description of the last load() failure
+    const std::string& getLastError() const noexcept {
+        return m_lastError;
+    }
+
+    const TextureList& getTextureList() const noexcept {
+        return m_textureList;
+    }
+
+    TextureList& getTextureList() noexcept {
+        return m_textureList;
+    }
+
+private:
+    //! Span of a map block row in the source text
+    struct RowSpan {
+        const char* begin;
+        const char* end;
+        const char* lineBegin;
+        size_t line;
+    };
+
+    bool setMapInfo(const Cell* array, uint32_t rows, uint32_t cols);
+    bool setMapInfo(std::vector<Cell>&& cells, uint32_t rows, uint32_t cols);
+    bool loadBinary(const char* data, size_t size);
+
+    bool scanMapBlock(
+        const char*& pos,
+        const char* end,
+        size_t& line,
+        const char*& lineBegin,
+        std::vector<RowSpan>& spans);
+
+    static bool decodeMapRow(
+        const RowSpan& span,
+        const char* textEnd,
+        Cell* cells,
+        size_t maxCells,
+        size_t& count,
+        std::string& error);
+
+    static bool decodeMapRows(
+        const RowSpan* spans,
+        size_t rowCount,
+        const char* textEnd,
+        Cell* cells,
+        size_t cols,
+        std::string& error);
+
+    bool loadMapBlock(
+        const char*& pos,
+        const char* end,
+        size_t line,
+        const char* lineBegin,
+        std::vector<Cell>& cells,
+        int& rows,
+        int& cols);
+
+    static std::string formatError(size_t line, size_t col, const std::string& what);
+    bool setError(size_t line, size_t col, const std::string& what);
+
+    // Minimum size of the text of a map block decoded by a single task
+    enum { MIN_BLOCK_BYTES = 256 * 1024 };
+
+    // Cells are stored row by row
+    std::vector<Cell> m_cells;
+    int m_rows = 0;
+    int m_cols = 0;
+
+    int m_cellDx = 256;
+    int m_cellDy = 256;
+
+    int m_maxX = 0;
+    int m_maxY = 0;
+
+    Point2d m_playerCellPos{ 0,0 };
+
+    // Textures are owned by the loader (see TextureLoader), unless
+    // they are fetched from a cache
+    const BitmapBuffer* m_texture[256] = { 0 };
+    TextureCache* m_textureCache = nullptr;
+
+    TextureList m_textureList;
+
+    std::string m_lastError;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif
@@ -31,7 +31,7 @@ namespace mip {
 //! Abstract base class of escape sequences converter
 struct base_esc_cnvrtr_t {
     virtual ~base_esc_cnvrtr_t() {}
-    virtual bool convert(const string_t& str, size_t & rcnt, char_t & ch) const = 0;
+    virtual bool convert(string_view_t str, size_t & rcnt, char_t & ch) const = 0;
     virtual char_t escape_char() const noexcept = 0;
 };
 
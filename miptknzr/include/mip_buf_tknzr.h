@@ -0,0 +1,132 @@
+//
+// This file is part of MipTknzr Library Project
+// Copyright (c) Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.
+// Licensed under the MIT License.
+// See COPYING file in the project root for full license information.
+//
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __MIP_BUF_TKNZR_H__
+#define __MIP_BUF_TKNZR_H__
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "mip_token_view.h"
+#include "mip_tknzr_def.h"
+
+#include <memory>
+#include <set>
+#include <map>
+#include <string>
+
+
+/* -------------------------------------------------------------------------- */
+
+namespace mip {
+
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Tokenizer which runs over a contiguous text buffer (e.g. a memory-mapped
+ * file, see mmap_file_t). It produces token_view_t objects referring to
+ * slices of the buffer, so it does not allocate memory per token or per
+ * character. It recognizes the same definitions of tknzr_t, and is built
+ * by tknzr_bldr_t::build_buf() or from shared definitions: the object
+ * is just a cursor over the text, so many of them can run concurrently
+ */
+class buf_tknzr_t
+{
+    friend class chunk_tknzr_t;
+
+public:
+    using ml_commdef_t = tknzr_def_t::ml_commdef_t;
+
+    //! ctor
+    //! @param def are the definitions built by tknzr_bldr_t::build_def()
+    explicit buf_tknzr_t(tknzr_def_ptr_t def) noexcept : _def(std::move(def)) {}
+
+    //! Set the text to tokenize; text is not copied and must outlive
+    //! the tokens
+    void reset(string_view_t text) noexcept;
+
+    //! Get next token found in the text, return false in case of error
+    //! The last token of the text is END_OF_FILE
+    bool next(token_view_t & tkn);
+
+    //! Move forward the cursor to a given position of the text, so that
+    //! a text section parsed by other means can be skipped
+    void skip(const char_t* pos) noexcept;
+
+    //! Return true if there is no more data to process
+    bool eos() const noexcept {
+        return _eos;
+    }
+
+    //! Convert the escape sequences of a string token value
+    //! @return true in case of success, false otherwise
+    bool unescape(const token_view_t & tkn, string_t & value) const;
+
+private:
+    buf_tknzr_t(const buf_tknzr_t&) = delete;
+    buf_tknzr_t& operator=(const buf_tknzr_t&) = delete;
+
+    size_t _offset() const noexcept {
+        return size_t(_pos - _line_begin);
+    }
+
+    const char_t* _find_eol(const char_t* p) const noexcept;
+    void _next_line(const char_t* p) noexcept;
+
+    bool _string_len(size_t & len) const;
+
+    void _emit(
+        token_view_t & tkn,
+        token_t::tcl_t tkncl,
+        size_t len,
+        char_t quote = 0,
+        char_t esc = 0) noexcept;
+
+    bool _get_other(token_view_t & tkn) noexcept;
+    bool _get_comment(token_view_t & tkn, const string_t & end_comment) noexcept;
+
+    const char_t* _begin = nullptr;
+    const char_t* _end = nullptr;
+    const char_t* _pos = nullptr;
+    const char_t* _line_begin = nullptr;
+    const char_t* _line_end = nullptr;
+    const char_t* _other = nullptr;
+
+    size_t _line = 0;
+    bool _eos = true;
+
+    // The text is followed by more text (see chunk_tknzr_t): neither
+    // END_OF_FILE nor unterminated comments are returned
+    bool _partial = false;
+
+    // Lines of the next multi-line comment already searched for its end
+    // (by a previous partial run), and offset of the first line still
+    // to search from the comment begin; 0 lines means none
+    size_t _comment_lines = 0;
+    size_t _comment_skip = 0;
+
+    const tkn_dfa_t& _dfa() const noexcept {
+        return _def->dfa();
+    }
+
+    tknzr_def_ptr_t _def;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+} // namespace mip
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif // __MIP_BUF_TKNZR_H__
@@ -0,0 +1,105 @@
+//
+// This file is part of MipTknzr Library Project
+// Copyright (c) Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.
+// Licensed under the MIT License.
+// See COPYING file in the project root for full license information.
+//
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __MIP_CHUNK_TKNZR_H__
+#define __MIP_CHUNK_TKNZR_H__
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "mip_buf_tknzr.h"
+
+#include <functional>
+#include <string>
+
+
+/* -------------------------------------------------------------------------- */
+
+namespace mip {
+
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Push tokenizer: the text is fed in chunks of any size (e.g. as they are
+ * read from a file or come out of a decompressor) and tokens are passed to
+ * a handler as soon as they are complete, so tokenization overlaps I/O.
+ * A chunk may split a token, a string or a multi-line comment anywhere:
+ * the incomplete tail is kept in an internal buffer until the following
+ * chunks complete it. Tokens are recognized a text line at a time, and a
+ * multi-line comment once its end has been received; the tokens produced
+ * are the same of buf_tknzr_t run over the whole text
+ */
+class chunk_tknzr_t
+{
+public:
+    //! Token handler: the token refers to the internal buffer and is
+    //! valid during the call only (see tkn_arena_t to keep it)
+    using handler_t = std::function<void(const token_view_t&)>;
+
+    //! ctor
+    //! @param def are the definitions built by tknzr_bldr_t::build_def()
+    explicit chunk_tknzr_t(tknzr_def_ptr_t def) : _tknzr(std::move(def)) {}
+
+    //! Feed the next chunk of text, passing completed tokens to handler
+    //! @return false in case of error
+    bool push(string_view_t chunk, const handler_t & handler);
+
+    //! Signal the end of the text: remaining tokens, followed by
+    //! END_OF_FILE, are passed to handler. Then the object is ready
+    //! for a new text
+    //! @return false in case of error
+    bool finish(const handler_t & handler);
+
+    //! Discard any pending text and restart from the first line
+    void reset() noexcept;
+
+    //! Return the number of buffered characters waiting to be tokenized
+    size_t pending() const noexcept {
+        return _buf.size();
+    }
+
+    //! Convert the escape sequences of a string token value
+    //! @return true in case of success, false otherwise
+    bool unescape(const token_view_t & tkn, string_t & value) const {
+        return _tknzr.unescape(tkn, value);
+    }
+
+private:
+    chunk_tknzr_t(const chunk_tknzr_t&) = delete;
+    chunk_tknzr_t& operator=(const chunk_tknzr_t&) = delete;
+
+    bool _run(size_t len, bool last, const handler_t & handler);
+
+    buf_tknzr_t _tknzr;
+
+    // Text not yet tokenized: it begins at a line start, while the
+    // tokenizing resumes at _resume (i.e. at an unterminated
+    // multi-line comment found in the middle of the line)
+    string_t _buf;
+    size_t _resume = 0;
+    size_t _line = 0;
+
+    // Lines of the open multi-line comment already searched for its
+    // end (see buf_tknzr_t), so that each line is searched once
+    size_t _comment_lines = 0;
+    size_t _comment_skip = 0;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+} // namespace mip
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif // __MIP_CHUNK_TKNZR_H__
@@ -33,8 +33,8 @@ class esc_cnvrtr_t : public base_esc_cnvrtr_t
 {
 private:
     static void _tail(string_t & str, size_t cnt = 1);
-    static bool _octal2dec(const string_t & str, unsigned int& res, size_t & cnt);
-    static bool _hex2dec(const string_t & str, unsigned int& res, size_t & cnt);
+    static bool _octal2dec(string_view_t str, unsigned int& res, size_t & cnt);
+    static bool _hex2dec(string_view_t str, unsigned int& res, size_t & cnt);
 
     char_t _esc_char = _T('\\');
 
@@ -59,7 +59,7 @@ public:
     //! @param rcnt is the number of character of escape sequnce (including esc prefix)
     //! @param ch is a converted character
     //! @return true in case of success, false otherwise
-    bool convert(const string_t& str, size_t & rcnt, char_t & ch) const override;
+    bool convert(string_view_t str, size_t & rcnt, char_t & ch) const override;
 };
 
 
@@ -0,0 +1,100 @@
+//
+// This file is part of MipTknzr Library Project
+// Copyright (c) Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.
+// Licensed under the MIT License.
+// See COPYING file in the project root for full license information.
+//
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __MIP_MMAP_FILE_H__
+#define __MIP_MMAP_FILE_H__
+
+
+/* -------------------------------------------------------------------------- */
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+/* -------------------------------------------------------------------------- */
+
+namespace mip {
+
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Read-only view of a whole file content.
+ * The file is memory-mapped when the platform allows it, otherwise it is
+ * read in one go into an internal buffer
+ */
+class mmap_file_t
+{
+public:
+    mmap_file_t() = default;
+    mmap_file_t(const mmap_file_t&) = delete;
+    mmap_file_t& operator=(const mmap_file_t&) = delete;
+
+    //! dtor
+    ~mmap_file_t() {
+        close();
+    }
+
+    //! Map (or read) a given file, return false in case of error
+    bool open(const std::string& file_name);
+
+    //! Release the file content
+    void close() noexcept;
+
+    //! Return true if a file content is available
+    bool is_open() const noexcept {
+        return _data != nullptr;
+    }
+
+    //! Return true if the content is memory-mapped
+    bool is_mapped() const noexcept {
+        return _mapped;
+    }
+
+    //! Return the file content
+    const char* data() const noexcept {
+        return _data;
+    }
+
+    //! Return the file size in bytes
+    size_t size() const noexcept {
+        return _size;
+    }
+
+    //! Return the file content as a string view
+    std::string_view view() const noexcept {
+        return std::string_view(_data ? _data : "", _size);
+    }
+
+private:
+    bool _read(const std::string& file_name);
+
+    const char* _data = nullptr;
+    size_t _size = 0;
+    bool _mapped = false;
+    std::vector<char> _buf;
+
+#ifdef _WIN32
+    void* _file = nullptr;
+    void* _mapping = nullptr;
+#endif
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+} // namespace mip
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif // __MIP_MMAP_FILE_H__
@@ -0,0 +1,244 @@
+//
+// This file is part of MipTknzr Library Project
+// Copyright (c) Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.
+// Licensed under the MIT License.
+// See COPYING file in the project root for full license information.
+//
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __MIP_TKN_ARENA_H__
+#define __MIP_TKN_ARENA_H__
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "mip_token_view.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+
+/* -------------------------------------------------------------------------- */
+
+namespace mip {
+
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Compact token record: the value is a slice of the source text or of
+ * the arena text pool
+ */
+struct tkn_rec_t {
+    size_t pos = 0;         //!< value position in the source or in the pool
+    uint32_t length = 0;    //!< value length
+    uint32_t line = 0;      //!< source line number
+    uint32_t offset = 0;    //!< offset in the source line
+    uint8_t type = 0;       //!< token_t::tcl_t
+    char_t quote = 0;
+    char_t esc = 0;
+    uint8_t pooled = 0;     //!< the value is in the text pool
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Contiguous token store.
+ * Token records are kept in fixed-size blocks, so that the store grows
+ * without copying them nor allocating much more than needed. A value
+ * which is a slice of the source text (see set_source, e.g. a
+ * memory-mapped file) is referred to by its position in the source, any
+ * other value (e.g. an unescaped string, or a token read from a stream)
+ * is appended to a single text pool. Storing a token costs no allocation
+ * other than a new block once in a while and the amortized growth of the
+ * pool. All the memory is released in one shot by release() (or by the
+ * dtor)
+ */
+class tkn_arena_t
+{
+public:
+    enum : size_t {
+        //! Token records per block
+        BLOCK_SIZE = 65536
+    };
+
+    tkn_arena_t() = default;
+
+    tkn_arena_t(tkn_arena_t&& other) noexcept :
+        _blocks(std::move(other._blocks)),
+        _size(std::exchange(other._size, 0)),
+        _text(std::move(other._text)),
+        _source(std::exchange(other._source, string_view_t()))
+    {}
+
+    tkn_arena_t& operator=(tkn_arena_t&& other) noexcept {
+        _blocks = std::move(other._blocks);
+        _size = std::exchange(other._size, 0);
+        _text = std::move(other._text);
+        _source = std::exchange(other._source, string_view_t());
+        return *this;
+    }
+
+    tkn_arena_t(const tkn_arena_t&) = delete;
+    tkn_arena_t& operator=(const tkn_arena_t&) = delete;
+
+    //! Pre-allocate room for a given number of tokens and characters
+    //! copied into the text pool
+    void reserve(size_t tokens, size_t chars) {
+        while (_blocks.size() * BLOCK_SIZE < tokens) {
+            _blocks.emplace_back(new tkn_rec_t[BLOCK_SIZE]);
+        }
+
+        _text.reserve(chars);
+    }
+
+    //! Set the text the values of the next tokens are referred to in,
+    //! instead of being copied, when they are slices of it: source must
+    //! outlive the tokens. Values referring to a previous source are
+    //! copied into the text pool first
+    void set_source(string_view_t source) {
+        if (source.data() == _source.data() && source.size() == _source.size()) {
+            return;
+        }
+
+        for (size_t i = 0; i < _size; ++i) {
+            auto & rec = _rec(i);
+
+            if (!rec.pooled) {
+                const char_t* value = _source.data() + rec.pos;
+
+                rec.pos = _text.size();
+                rec.pooled = 1;
+
+                _text.insert(_text.end(), value, value + rec.length);
+            }
+        }
+
+        _source = source;
+    }
+
+    //! Append a token referring to its value in the source text, if it
+    //! is a slice of it, or copying its value into the text pool
+    void push(
+        token_t::tcl_t type,
+        string_view_t value,
+        size_t line,
+        size_t offset,
+        char_t quote = 0,
+        char_t esc = 0)
+    {
+        if (_size == _blocks.size() * BLOCK_SIZE) {
+            _blocks.emplace_back(new tkn_rec_t[BLOCK_SIZE]);
+        }
+
+        tkn_rec_t & rec = _rec(_size);
+
+        rec.length = uint32_t(value.size());
+        rec.line = uint32_t(line);
+        rec.offset = uint32_t(offset);
+        rec.type = uint8_t(type);
+        rec.quote = quote;
+        rec.esc = esc;
+
+        if (_in_source(value)) {
+            rec.pos = size_t(value.data() - _source.data());
+            rec.pooled = 0;
+        }
+        else {
+            rec.pos = _text.size();
+            rec.pooled = 1;
+
+            _text.insert(_text.end(), value.begin(), value.end());
+        }
+
+        ++_size;
+    }
+
+    //! Append a token view
+    void push(const token_view_t & tkn) {
+        const auto quote_esc = tkn.get_quote_esc();
+
+        push(tkn.type(), tkn.value(), tkn.line(), tkn.offset(),
+            quote_esc.first, quote_esc.second);
+    }
+
+    //! Return the number of tokens
+    size_t size() const noexcept {
+        return _size;
+    }
+
+    //! Return true if there are no tokens
+    bool empty() const noexcept {
+        return _size == 0;
+    }
+
+    //! Return the i-th token record
+    const tkn_rec_t & record(size_t i) const noexcept {
+        return _blocks[i / BLOCK_SIZE][i % BLOCK_SIZE];
+    }
+
+    //! Return the value of a token record
+    string_view_t value(const tkn_rec_t & rec) const noexcept {
+        return string_view_t(
+            (rec.pooled ? _text.data() : _source.data()) + rec.pos, rec.length);
+    }
+
+    //! Return the i-th token, valid until the arena is modified
+    token_view_t operator[](size_t i) const noexcept {
+        const auto & rec = record(i);
+
+        return token_view_t(
+            token_t::tcl_t(rec.type), value(rec),
+            rec.line, rec.offset, rec.quote, rec.esc);
+    }
+
+    //! Remove all the tokens keeping the allocated memory
+    void clear() noexcept {
+        _size = 0;
+        _text.clear();
+        _source = string_view_t();
+    }
+
+    //! Remove all the tokens and release the memory
+    void release() noexcept {
+        _size = 0;
+        std::vector<std::unique_ptr<tkn_rec_t[]>>().swap(_blocks);
+        std::vector<char_t>().swap(_text);
+        _source = string_view_t();
+    }
+
+private:
+    tkn_rec_t & _rec(size_t i) noexcept {
+        return _blocks[i / BLOCK_SIZE][i % BLOCK_SIZE];
+    }
+
+    bool _in_source(string_view_t value) const noexcept {
+        const std::less<const char_t*> less;
+
+        return !value.empty() && !_source.empty() &&
+            !less(value.data(), _source.data()) &&
+            !less(_source.data() + _source.size(), value.data() + value.size());
+    }
+
+    std::vector<std::unique_ptr<tkn_rec_t[]>> _blocks;
+    size_t _size = 0;
+    std::vector<char_t> _text;
+    string_view_t _source;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+} // namespace mip
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif // __MIP_TKN_ARENA_H__
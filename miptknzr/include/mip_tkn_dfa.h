@@ -0,0 +1,163 @@
+//
+// This file is part of MipTknzr Library Project
+// Copyright (c) Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.
+// Licensed under the MIT License.
+// See COPYING file in the project root for full license information.
+//
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __MIP_TKN_DFA_H__
+#define __MIP_TKN_DFA_H__
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "mip_base_tknzr.h"
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+/* -------------------------------------------------------------------------- */
+
+namespace mip {
+
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Compiled form of the tokenizer definitions.
+ * A first-character dispatch table tells with one lookup which kind of
+ * definitions may begin at a given text position (none for most of the
+ * characters of an "other" token), and a trie of all atom, blank and
+ * comment definitions finds the matching one in a single walk
+ */
+class tkn_dfa_t
+{
+public:
+    //! Definition classes, in the order tokenizers give them priority
+    enum class cl_t : uint8_t {
+        ML_COMMENT,
+        BLANK,
+        SL_COMMENT,
+        ATOM,
+        CL_CNT
+    };
+
+    //! Dispatch table flags
+    enum : uint8_t {
+        F_ML_COMMENT = 1 << uint8_t(cl_t::ML_COMMENT),
+        F_BLANK = 1 << uint8_t(cl_t::BLANK),
+        F_SL_COMMENT = 1 << uint8_t(cl_t::SL_COMMENT),
+        F_ATOM = 1 << uint8_t(cl_t::ATOM),
+        F_STRING = 1 << 4,
+        F_EOL = 1 << 5
+    };
+
+    //! Result of match()
+    struct match_t {
+        cl_t cl = cl_t::CL_CNT;
+        size_t len = 0;
+        const string_t* end_comment = nullptr;
+    };
+
+    /**
+     * Compile the definitions
+     * Within a class the longest definition is matched, but for
+     * multi-line comments for which the first one (in set order) is
+     * taken, as tknzr_t always did
+     */
+    void compile(
+        const std::set<string_t>& blkdef,
+        const std::set<string_t>& atomdef,
+        const std::set<base_tknzr_t::eol_t>& eoldef,
+        const std::set<string_t>& sl_comdef,
+        const std::set<std::pair<string_t, string_t>>& ml_comdef,
+        const std::set<char_t>& quotes);
+
+    //! Return the dispatch flags of a character
+    uint8_t first(char_t ch) const noexcept {
+        return _first[_index(ch)];
+    }
+
+    /**
+     * Search the definition matching the text beginning at p
+     * (p < end) giving priority to classes in cl_t order
+     * @return true if a definition has been found, false otherwise
+     */
+    bool match(const char_t* p, const char_t* end, match_t & m) const noexcept;
+
+    /**
+     * Return the first character of [p, end) which may begin a definition
+     * (end-of-line apart), or end if there is none. The characters are
+     * compared 16 (or 32) at a time with SIMD instructions when available,
+     * so that long runs of "other" characters are skipped in a few steps
+     */
+    const char_t* skip_other(const char_t* p, const char_t* end) const noexcept;
+
+private:
+    // Up to MAX_STOP characters which may begin a definition are compared
+    // in parallel by skip_other(), each one replicated in a row of
+    // _stop_vec; rows are padded to a multiple of 4 by repeating the first
+    // one. If they are more, skip_other() uses the dispatch table
+    static constexpr size_t MAX_STOP = 16;
+    static constexpr size_t STOP_VEC_SIZE = 16;
+
+    const char_t* _skip_other_simd(const char_t* p, const char_t* end) const noexcept;
+    // Characters out of the table range share the last entry
+    static constexpr size_t TABLE_SIZE = 257;
+
+    static size_t _index(char_t ch) noexcept {
+        using uchar_t = std::make_unsigned<char_t>::type;
+        const auto i = size_t(uchar_t(ch));
+        return i < TABLE_SIZE - 1 ? i : TABLE_SIZE - 1;
+    }
+
+    struct node_t {
+        uint32_t edge_begin = 0;
+        uint32_t edge_end = 0;
+        uint8_t accept = 0;       // class flags of definitions ending here
+        uint32_t ml_end = 0;      // index in _ml_end
+    };
+
+    struct edge_t {
+        char_t ch;
+        uint32_t node;
+    };
+
+    uint32_t _child(const node_t& node, char_t ch) const noexcept {
+        for (auto i = node.edge_begin; i < node.edge_end; ++i) {
+            if (_edges[i].ch == ch) {
+                return _edges[i].node;
+            }
+        }
+
+        return 0;
+    }
+
+    uint8_t _first[TABLE_SIZE] = { 0 };
+    uint32_t _root[TABLE_SIZE] = { 0 };  // root children (0 for none)
+    std::vector<node_t> _nodes;  // _nodes[0] is the root
+    std::vector<edge_t> _edges;
+    std::vector<string_t> _ml_end;
+
+    alignas(16) uint8_t _stop_vec[MAX_STOP][STOP_VEC_SIZE] = { { 0 } };
+    size_t _stop_cnt = 0;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+} // namespace mip
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif // __MIP_TKN_DFA_H__
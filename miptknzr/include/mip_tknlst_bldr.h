@@ -17,6 +17,7 @@
 
 #include "mip_token.h"
 #include "mip_tknzr_bldr.h"
+#include "mip_tkn_arena.h"
 
 #include <list>
 #include <memory>
@@ -84,6 +85,61 @@ public:
         return _build(is, nonblnks, blnks);
     }
 
+
+    /**
+     * Builds a contiguous vector of tokens from an input stream
+     * @param is must be an input stream
+     * @param nonblnks will hold non-blank classified tokens
+     * @return true in case of success, false otherwise
+     */
+    bool build(_istream& is, tkn_arena_t & nonblnks) {
+        return _build(is, nonblnks);
+    }
+
+
+    /**
+     * Builds two contiguous vectors of tokens from an input stream
+     * separating non-blanks from blanks classified tokens
+     * @param is must be an input stream
+     * @param nonblnks will hold non-blank classified tokens
+     * @param blnks will hold blank classified tokens
+     * @return true in case of success, false otherwise
+     */
+    bool build(_istream& is, tkn_arena_t & nonblnks, tkn_arena_t & blnks) {
+        return _build(is, nonblnks, blnks);
+    }
+
+
+    /**
+     * Builds contiguous vectors of tokens from a text buffer (e.g. a
+     * memory-mapped file) separating non-blanks from blanks classified
+     * tokens. String values are stored unescaped. Token values refer to
+     * the text (see tkn_arena_t::set_source), but for the strings with
+     * escape sequences
+     * @param text is the text to tokenize, it must outlive the tokens
+     * @param nonblnks will hold non-blank classified tokens
+     * @param blnks will hold blank classified tokens
+     * @return true in case of success, false otherwise
+     */
+    bool build(
+        string_view_t text,
+        tkn_arena_t & nonblnks,
+        tkn_arena_t & blnks)
+    {
+        return _build_buf(text, nonblnks, blnks);
+    }
+
+
+    /**
+     * Builds a contiguous vector of tokens from a text buffer
+     * @param text is the text to tokenize, it must outlive the tokens
+     * @param nonblnks will hold non-blank classified tokens
+     * @return true in case of success, false otherwise
+     */
+    bool build(string_view_t text, tkn_arena_t & nonblnks) {
+        return _build_buf(text, nonblnks);
+    }
+
 private:
     
 
@@ -112,6 +168,99 @@ private:
     }
 
 
+    // -------------------------------------------------------------------------
+
+    template <class T>
+    void _insert(const T & tkn, tkn_arena_t & nonblnks) {
+        if (_blnks.find(tkn.type()) == _blnks.end()) {
+            _push(tkn, nonblnks);
+        }
+    }
+
+
+    // -------------------------------------------------------------------------
+
+    template <class T>
+    void _insert(const T & tkn, tkn_arena_t & nonblnks, tkn_arena_t & blanks) {
+        _push(tkn, _blnks.find(tkn.type()) == _blnks.end() ? nonblnks : blanks);
+    }
+
+
+    // -------------------------------------------------------------------------
+
+    void _insert(std::unique_ptr<token_t> tkn, tkn_arena_t & nonblnks) {
+        _insert(*tkn, nonblnks);
+    }
+
+
+    // -------------------------------------------------------------------------
+
+    void _insert(
+        std::unique_ptr<token_t> tkn,
+        tkn_arena_t & nonblnks,
+        tkn_arena_t & blanks)
+    {
+        _insert(*tkn, nonblnks, blanks);
+    }
+
+
+    // -------------------------------------------------------------------------
+
+    void _push(const token_t & tkn, tkn_arena_t & arena) {
+        const auto quote_esc = tkn.get_quote_esc();
+
+        arena.push(tkn.type(), tkn.value(), tkn.line(), tkn.offset(),
+            quote_esc.first, quote_esc.second);
+    }
+
+
+    // -------------------------------------------------------------------------
+
+    void _push(const token_view_t & tkn, tkn_arena_t & arena) {
+        const auto quote_esc = tkn.get_quote_esc();
+
+        // Only the strings with escape sequences are copied
+        if (tkn.type() != token_t::tcl_t::STRING ||
+            !quote_esc.second ||
+            tkn.value().find(quote_esc.second) == string_view_t::npos)
+        {
+            arena.push(tkn);
+            return;
+        }
+
+        // _value is reused, so unescaping allocates only when it grows
+        _buf_tknzr->unescape(tkn, _value);
+
+        arena.push(tkn.type(), _value, tkn.line(), tkn.offset(),
+            quote_esc.first, quote_esc.second);
+    }
+
+
+    // -------------------------------------------------------------------------
+
+    template <class ... T>
+    bool _build_buf(string_view_t text, T& ... args) {
+        _buf_tknzr = _tknzr_bldr.build_buf();
+
+        if (!_buf_tknzr) {
+            return false;
+        }
+
+        _buf_tknzr->reset(text);
+
+        // Token values are referred to in the text
+        (_set_source(args, text), ...);
+
+        token_view_t tkn;
+
+        while (_buf_tknzr->next(tkn)) {
+            _insert(tkn, args...);
+        }
+
+        return true;
+    }
+
+
     // -------------------------------------------------------------------------
 
     template <class ... T>
@@ -122,6 +271,9 @@ private:
             return false;
         }
 
+        // Token values read from a stream are copied
+        (_set_source(args, string_view_t()), ...);
+
         while (! _tknzr->eos(is)) {
             if (is.bad()) {
                 return false;
@@ -140,11 +292,22 @@ private:
     }
 
 
+    // -------------------------------------------------------------------------
+
+    static void _set_source(tkn_arena_t & arena, string_view_t text) {
+        arena.set_source(text);
+    }
+
+    static void _set_source(tknlist_t &, string_view_t) noexcept {}
+
+
     // -------------------------------------------------------------------------
 
     tknzr_bldr_t _tknzr_bldr;
     std::set<token_t::tcl_t> _blnks;
     std::unique_ptr<base_tknzr_t> _tknzr;
+    std::unique_ptr<buf_tknzr_t> _buf_tknzr;
+    string_t _value;
 };
 
 
@@ -18,6 +18,7 @@
 #include "mip_token.h"
 #include "mip_base_tknzr.h"
 #include "mip_base_esc_cnvrtr.h"
+#include "mip_tknzr_def.h"
 
 #include <memory>
 #include <istream>
@@ -33,12 +34,20 @@ namespace mip {
 
 /* -------------------------------------------------------------------------- */
 
+/**
+ * Tokenizer of input streams.
+ * It holds the state of a single parse and shares its (immutable)
+ * definitions, so one tokenizer per stream can be created from the same
+ * definitions, even in different threads
+ */
 class tknzr_t : public base_tknzr_t
 {
-    friend class tknzr_bldr_t;
-
 public:
-    using ml_commdef_t = std::pair<string_t, string_t>;
+    using ml_commdef_t = tknzr_def_t::ml_commdef_t;
+
+    //! ctor
+    //! @param def are the definitions built by tknzr_bldr_t::build_def()
+    explicit tknzr_t(tknzr_def_ptr_t def) noexcept : _def(std::move(def)) {}
 
     //! Return next token found in a given input stream
     std::unique_ptr<token_t> next(_istream & is) override;
@@ -51,7 +60,6 @@ public:
 
     
 private:
-    tknzr_t() noexcept {}
     tknzr_t(const tknzr_t&) = delete;
     tknzr_t& operator=(const tknzr_t&) = delete;
 
@@ -69,23 +77,11 @@ private:
 
     bool _eof = false;
 
-    static bool _is_prefix_ch(
-        const char_t ch, 
-        const std::set<string_t> & tknset);
-
-    static std::set<string_t>::const_reverse_iterator _search_token(
-        const std::set<string_t>& tknset,
-        string_t & line);
-
     static string_t _extract_token(
         const string_t& set_tkn,
         string_t & line,
         get_t cut_type);
 
-    bool _ml_comment_begin(
-        const std::set<ml_commdef_t> & tknset,
-        string_t & end_comment);
-
     void _reset();
 
     bool _getline(
@@ -104,21 +100,22 @@ private:
     std::unique_ptr<token_t> _search_eof();
     std::unique_ptr<token_t> _search_eol();
     std::unique_ptr<token_t> _search_other_tkn();
-    std::unique_ptr<token_t> _get_comment(_istream & is);
+    std::unique_ptr<token_t> _get_comment(
+        _istream & is,
+        string_t & end_comment);
 
     std::unique_ptr<token_t> _get_tkn(
-        const std::set<string_t> & tknset,
+        size_t len,
         token_t::tcl_t tkncl,
         get_t cut_type);
 
     std::unique_ptr<token_t> _get_string();
 
-    std::set<string_t> _blkdef;
-    std::set<string_t> _atomdef;
-    std::set<base_tknzr_t::eol_t> _eoldef;
-    std::set<string_t> _sl_comdef;
-    std::set<ml_commdef_t> _ml_comdef;
-    std::map< char_t /*quote*/, std::shared_ptr<base_esc_cnvrtr_t > > _strdef;
+    const tkn_dfa_t& _dfa() const noexcept {
+        return _def->dfa();
+    }
+
+    tknzr_def_ptr_t _def;
 };
 
 
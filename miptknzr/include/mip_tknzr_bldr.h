@@ -16,7 +16,10 @@
 /* -------------------------------------------------------------------------- */
 
 #include "mip_base_tknzr_bldr.h"
+#include "mip_tknzr_def.h"
 #include "mip_tknzr.h"
+#include "mip_buf_tknzr.h"
+#include "mip_chunk_tknzr.h"
 
 #include <cassert>
 #include <memory>
@@ -33,15 +36,11 @@ namespace mip {
 class tknzr_bldr_t : public base_tknzr_bldr_t
 {
 private:
-    bool _build_tknzr();
+    tknzr_def_t& _edit_def();
 
     template <class T, class S>
     bool _def_item(const T& value, S& set)
     {
-        if (!_build_tknzr()) {
-            return false;
-        }
-
         auto it = set.find(value);
 
         if (it != set.end()) {
@@ -67,15 +66,29 @@ private:
         return res;
     }
 
-    std::unique_ptr< tknzr_t > _tknzr;
+    std::shared_ptr< tknzr_def_t > _def;
+    tknzr_def_ptr_t _compiled;
 
 public:
-    tknzr_bldr_t() noexcept : _tknzr(new tknzr_t()) {
-        assert(_tknzr);
+    tknzr_bldr_t() : _def(std::make_shared<tknzr_def_t>()) {
     }
 
+    /**
+     * Compile the definitions given so far. The result is cached until 
+     * a new definition is added, and it can be shared by any number of
+     * tokenizers (see tknzr_t, buf_tknzr_t and chunk_tknzr_t ctors)
+     */
+    tknzr_def_ptr_t build_def();
+
+    //! Build a tokenizer of input streams (see tknzr_t)
     std::unique_ptr< base_tknzr_t > build() override;
 
+    //! Build a tokenizer of in-memory text buffers (see buf_tknzr_t)
+    std::unique_ptr< buf_tknzr_t > build_buf();
+
+    //! Build a tokenizer of text fed in chunks (see chunk_tknzr_t)
+    std::unique_ptr< chunk_tknzr_t > build_chunk();
+
     bool def_atom(const string_t& value) override;
     bool def_atom(const std::set<string_t>& value_set) override;
 
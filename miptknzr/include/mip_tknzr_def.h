@@ -0,0 +1,113 @@
+//
+// This file is part of MipTknzr Library Project
+// Copyright (c) Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.
+// Licensed under the MIT License.
+// See COPYING file in the project root for full license information.
+//
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __MIP_TKNZR_DEF_H__
+#define __MIP_TKNZR_DEF_H__
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "mip_base_tknzr.h"
+#include "mip_base_esc_cnvrtr.h"
+#include "mip_tkn_dfa.h"
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+
+
+/* -------------------------------------------------------------------------- */
+
+namespace mip {
+
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Token definitions of a tokenizer, built and compiled by tknzr_bldr_t.
+ * Once built they are never modified: tokenizers (tknzr_t, buf_tknzr_t)
+ * share them and only hold the state of their own parse, so any number
+ * of tokenizers can run at the same time, also in different threads
+ */
+class tknzr_def_t
+{
+    friend class tknzr_bldr_t;
+
+public:
+    using ml_commdef_t = std::pair<string_t, string_t>;
+    using strdef_t = 
+        std::map< char_t /*quote*/, std::shared_ptr<base_esc_cnvrtr_t > >;
+
+    //! Return the blank definitions
+    const std::set<string_t>& blk_def() const noexcept {
+        return _blkdef;
+    }
+
+    //! Return the atomic token definitions
+    const std::set<string_t>& atom_def() const noexcept {
+        return _atomdef;
+    }
+
+    //! Return the single-line comment definitions
+    const std::set<string_t>& sl_com_def() const noexcept {
+        return _sl_comdef;
+    }
+
+    //! Return the multi-line comment definitions
+    const std::set<ml_commdef_t>& ml_com_def() const noexcept {
+        return _ml_comdef;
+    }
+
+    //! Return the string definitions (quote and escape converter)
+    const strdef_t& str_def() const noexcept {
+        return _strdef;
+    }
+
+    //! Return true if a given end-of-line marker is defined
+    bool has_eol(base_tknzr_t::eol_t eol) const noexcept {
+        return eol == base_tknzr_t::eol_t::CR ? _eol_cr : _eol_lf;
+    }
+
+    //! Return the compiled matcher
+    const tkn_dfa_t& dfa() const noexcept {
+        return _dfa;
+    }
+
+private:
+    void _compile();
+
+    std::set<string_t> _blkdef;
+    std::set<string_t> _atomdef;
+    std::set<base_tknzr_t::eol_t> _eoldef;
+    std::set<string_t> _sl_comdef;
+    std::set<ml_commdef_t> _ml_comdef;
+    strdef_t _strdef;
+
+    bool _eol_cr = false;
+    bool _eol_lf = false;
+    tkn_dfa_t _dfa;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+using tknzr_def_ptr_t = std::shared_ptr<const tknzr_def_t>;
+
+
+/* -------------------------------------------------------------------------- */
+
+} // namespace mip
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif // __MIP_TKNZR_DEF_H__
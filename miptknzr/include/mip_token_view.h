@@ -0,0 +1,105 @@
+//
+// This file is part of MipTknzr Library Project
+// Copyright (c) Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.
+// Licensed under the MIT License.
+// See COPYING file in the project root for full license information.
+//
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __MIP_TOKEN_VIEW_H__
+#define __MIP_TOKEN_VIEW_H__
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "mip_token.h"
+
+
+/* -------------------------------------------------------------------------- */
+
+namespace mip {
+
+
+/* -------------------------------------------------------------------------- */
+
+/**
+ * Token which refers to a slice of the tokenized text buffer instead of
+ * owning a copy of it. It is valid as long as the buffer is.
+ * The value of a string token is the text between the quotes, escape
+ * sequences included (see buf_tknzr_t::unescape())
+ */
+class token_view_t
+{
+public:
+    using tcl_t = token_t::tcl_t;
+
+    token_view_t() = default;
+
+    token_view_t(
+        tcl_t type,
+        string_view_t value,
+        size_t line,
+        size_t offset,
+        char_t quote = 0,
+        char_t esc = 0)
+        noexcept
+        :
+        _type(type),
+        _value(value),
+        _line(line),
+        _offset(offset),
+        _quote(quote),
+        _esc(esc)
+    {}
+
+    //! return quote and escape sequence prefix
+    std::pair<char_t, char_t> get_quote_esc() const noexcept {
+        return std::pair<char_t, char_t>(_quote, _esc);
+    }
+
+    //! return token type
+    tcl_t type() const noexcept {
+        return _type;
+    }
+
+    //! return token value
+    string_view_t value() const noexcept {
+        return _value;
+    }
+
+    //! return token line number
+    size_t line() const noexcept {
+        return _line;
+    }
+
+    //! return the token offset in the source text line
+    size_t offset() const noexcept {
+        return _offset;
+    }
+
+    //! return a token object owning a copy of the value
+    token_t to_token() const {
+        return token_t(_type, string_t(_value), _line, _offset, _quote, _esc);
+    }
+
+private:
+    tcl_t _type = tcl_t::OTHER;
+    string_view_t _value;
+    size_t _line = 0;
+    size_t _offset = 0;
+    char_t _quote = 0;
+    char_t _esc = 0;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+} // namespace mip
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif // __MIP_TOKEN_VIEW_H__
@@ -16,6 +16,7 @@
 /* -------------------------------------------------------------------------- */
 
 #include <string>
+#include <string_view>
 
 #define _T(x) __T(x)
 
@@ -47,6 +48,7 @@ using char_t = char;
 
 using _string = std::basic_string<char_t, std::char_traits<char_t> >;
 using string_t = _string;
+using string_view_t = std::basic_string_view<char_t, std::char_traits<char_t> >;
 using _ios = std::basic_ios<char_t, std::char_traits<char_t> >;
 using _streambuf = std::basic_streambuf<char_t, std::char_traits<char_t> >;
 using _istream = std::basic_istream<char_t, std::char_traits<char_t> >;
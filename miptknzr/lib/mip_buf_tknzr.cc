@@ -0,0 +1,404 @@
+//
+// This file is part of MipTknzr Library Project
+// Copyright (c) Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.
+// Licensed under the MIT License.
+// See COPYING file in the project root for full license information.
+//
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "../include/mip_buf_tknzr.h"
+
+
+/* -------------------------------------------------------------------------- */
+
+namespace mip {
+
+
+/* -------------------------------------------------------------------------- */
+
+using traits_t = std::char_traits<char_t>;
+
+
+/* -------------------------------------------------------------------------- */
+
+const char_t* buf_tknzr_t::_find_eol(const char_t* p) const noexcept
+{
+    const bool cr = _def->has_eol(base_tknzr_t::eol_t::CR);
+    const bool lf = _def->has_eol(base_tknzr_t::eol_t::LF);
+
+    if (cr != lf) {
+        const char_t* eol = traits_t::find(
+            p, size_t(_end - p), cr ? _T('\r') : _T('\n'));
+
+        return eol ? eol : _end;
+    }
+
+    if (cr) {
+        for (; p < _end; ++p) {
+            if (_dfa().first(*p) & tkn_dfa_t::F_EOL) {
+                return p;
+            }
+        }
+    }
+
+    return _end;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void buf_tknzr_t::_next_line(const char_t* p) noexcept
+{
+    ++_line;
+    _pos = _line_begin = p;
+    _line_end = _find_eol(p);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void buf_tknzr_t::reset(string_view_t text) noexcept
+{
+    _begin = text.data();
+    _end = _begin + text.size();
+    _pos = _line_begin = _begin;
+    _line_end = _find_eol(_begin);
+    _other = nullptr;
+    _line = 0;
+    _eos = false;
+    _partial = false;
+    _comment_lines = 0;
+    _comment_skip = 0;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void buf_tknzr_t::skip(const char_t* pos) noexcept
+{
+    if (pos < _pos || pos > _end) {
+        return;
+    }
+
+    while (_line_end < pos) {
+        _next_line(_line_end + 1);
+    }
+
+    _pos = pos;
+    _other = nullptr;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool buf_tknzr_t::_string_len(size_t & len) const
+{
+    const string_view_t line(_pos, size_t(_line_end - _pos));
+
+    if (line.size() < 2) {
+        return false;
+    }
+
+    const auto quote_ch = line[0];
+    auto quote_esc_it = _def->str_def().find(quote_ch);
+
+    if (quote_esc_it == _def->str_def().end()) {
+        return false;
+    }
+
+    const auto & esc_cnvt = quote_esc_it->second;
+    const char_t esc_ch = esc_cnvt ? esc_cnvt->escape_char() : 0;
+
+    for (size_t i = 1; i < line.size(); ++i) {
+        char_t ch = line[i];
+
+        if (esc_cnvt && ch == esc_ch) {
+            size_t remove_cnt = 0;
+
+            if (!esc_cnvt->convert(line.substr(i), remove_cnt, ch)) {
+                return false;
+            }
+
+            i += (remove_cnt - 1);
+        }
+        else if (ch == quote_ch) {
+            len = i + 1;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void buf_tknzr_t::_emit(
+    token_view_t & tkn,
+    token_t::tcl_t tkncl,
+    size_t len,
+    char_t quote,
+    char_t esc) noexcept
+{
+    if (tkncl == token_t::tcl_t::STRING) {
+        tkn = token_view_t(tkncl,
+            string_view_t(_pos + 1, len - 2), _line, _offset(), quote, esc);
+    }
+    else {
+        tkn = token_view_t(tkncl, string_view_t(_pos, len), _line, _offset());
+    }
+
+    _pos += len;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool buf_tknzr_t::_get_other(token_view_t & tkn) noexcept
+{
+    if (!_other) {
+        return false;
+    }
+
+    tkn = token_view_t(
+        token_t::tcl_t::OTHER,
+        string_view_t(_other, size_t(_pos - _other)),
+        _line,
+        size_t(_other - _line_begin));
+
+    _other = nullptr;
+
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool buf_tknzr_t::_get_comment(
+    token_view_t & tkn,
+    const string_t & end_comment) noexcept
+{
+    const char_t* comment_begin = _pos;
+    const char_t* comment_line_begin = _line_begin;
+    const char_t* comment_line_end = _line_end;
+    const size_t comment_line = _line;
+    const size_t comment_offset = _offset();
+
+    // Lines searched by a previous partial run are not searched again
+    if (_comment_lines) {
+        _line += _comment_lines;
+        _pos = _line_begin = comment_begin + _comment_skip;
+        _line_end = _find_eol(_pos);
+
+        _comment_lines = 0;
+        _comment_skip = 0;
+    }
+
+    // The end of comment is searched line by line, starting from the
+    // comment prefix (like tknzr_t does)
+    for (;;) {
+        const string_view_t line(_pos, size_t(_line_end - _pos));
+        const auto end_offset = line.find(end_comment);
+
+        if (end_offset != string_view_t::npos) {
+            _pos += end_offset + end_comment.size();
+            break;
+        }
+
+        if (_line_end == _end) {
+            if (_partial) {
+                // the end of comment may be in the text still to come:
+                // the next run resumes the search at this line
+                if (_line != comment_line) {
+                    _comment_lines = _line - comment_line;
+                    _comment_skip = size_t(_line_begin - comment_begin);
+                }
+
+                _pos = comment_begin;
+                _line_begin = comment_line_begin;
+                _line_end = comment_line_end;
+                _line = comment_line;
+                return false;
+            }
+
+            // unterminated comment: it extends up to the end of text
+            _pos = _end;
+            break;
+        }
+
+        _next_line(_line_end + 1);
+    }
+
+    tkn = token_view_t(
+        token_t::tcl_t::COMMENT,
+        string_view_t(comment_begin, size_t(_pos - comment_begin)),
+        comment_line,
+        comment_offset);
+
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool buf_tknzr_t::next(token_view_t & tkn)
+{
+    if (_eos) {
+        return false;
+    }
+
+    for (;;) {
+        if (_pos == _line_end) {
+            // other token
+            if (_get_other(tkn)) {
+                return true;
+            }
+
+            // end-of-line token
+            if (_line_end != _end) {
+                tkn = token_view_t(
+                    token_t::tcl_t::END_OF_LINE,
+                    string_view_t(_line_end, 1),
+                    _line,
+                    _offset());
+
+                _next_line(_line_end + 1);
+                return true;
+            }
+
+            // more text to come
+            if (_partial) {
+                return false;
+            }
+
+            // end-of-file (virtual) token
+            tkn = token_view_t(
+                token_t::tcl_t::END_OF_FILE,
+                string_view_t(),
+                _line,
+                _offset());
+
+            _eos = true;
+            return true;
+        }
+
+        const auto first = _dfa().first(*_pos);
+
+        // Characters which cannot begin any definition extend the
+        // other token as a whole run
+        if (!(first & ~tkn_dfa_t::F_EOL)) {
+            if (!_other) {
+                _other = _pos;
+            }
+
+            _pos = _dfa().skip_other(_pos + 1, _line_end);
+
+            continue;
+        }
+
+        tkn_dfa_t::match_t m;
+
+        // multi-line comment, blank, single-line comment or atom
+        if (_dfa().match(_pos, _line_end, m)) {
+            if (_get_other(tkn)) {
+                return true;
+            }
+
+            switch (m.cl) {
+            case tkn_dfa_t::cl_t::ML_COMMENT:
+                if (!_get_comment(tkn, *m.end_comment)) {
+                    return false;
+                }
+                break;
+
+            case tkn_dfa_t::cl_t::BLANK:
+                _emit(tkn, token_t::tcl_t::BLANK, m.len);
+                break;
+
+            case tkn_dfa_t::cl_t::SL_COMMENT:
+                _emit(tkn, token_t::tcl_t::COMMENT, size_t(_line_end - _pos));
+                break;
+
+            default:
+                _emit(tkn, token_t::tcl_t::ATOM, m.len);
+                break;
+            }
+
+            return true;
+        }
+
+        size_t len = 0;
+
+        // string
+        if ((first & tkn_dfa_t::F_STRING) && _string_len(len)) {
+            if (!_get_other(tkn)) {
+                const auto & esc_cnvt = _def->str_def().find(*_pos)->second;
+
+                _emit(tkn, token_t::tcl_t::STRING, len, *_pos,
+                    esc_cnvt ? esc_cnvt->escape_char() : 0);
+            }
+
+            return true;
+        }
+
+        // extend the other token
+        if (!_other) {
+            _other = _pos;
+        }
+
+        ++_pos;
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool buf_tknzr_t::unescape(const token_view_t & tkn, string_t & value) const
+{
+    const auto quote_esc = tkn.get_quote_esc();
+    const auto text = tkn.value();
+
+    value.clear();
+
+    auto it = _def->str_def().find(quote_esc.first);
+
+    if (tkn.type() != token_t::tcl_t::STRING ||
+        it == _def->str_def().end() ||
+        !it->second ||
+        text.find(quote_esc.second) == string_view_t::npos)
+    {
+        value.assign(text.data(), text.size());
+        return true;
+    }
+
+    value.reserve(text.size());
+
+    for (size_t i = 0; i < text.size(); ++i) {
+        char_t ch = text[i];
+
+        if (ch == quote_esc.second) {
+            size_t remove_cnt = 0;
+
+            if (!it->second->convert(text.substr(i), remove_cnt, ch)) {
+                return false;
+            }
+
+            i += (remove_cnt - 1);
+        }
+
+        value += ch;
+    }
+
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+} // namespace mip
+
+
+/* -------------------------------------------------------------------------- */
@@ -0,0 +1,109 @@
+//
+// This file is part of MipTknzr Library Project
+// Copyright (c) Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.
+// Licensed under the MIT License.
+// See COPYING file in the project root for full license information.
+//
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "../include/mip_chunk_tknzr.h"
+
+
+/* -------------------------------------------------------------------------- */
+
+namespace mip {
+
+
+/* -------------------------------------------------------------------------- */
+
+bool chunk_tknzr_t::push(string_view_t chunk, const handler_t & handler)
+{
+    const size_t old_size = _buf.size();
+
+    _buf.append(chunk.data(), chunk.size());
+
+    // Only complete lines can be tokenized: a token at the end of the
+    // text could be continued by the next chunk
+    const tkn_dfa_t& dfa = _tknzr._dfa();
+
+    for (size_t i = _buf.size(); i > old_size; --i) {
+        if (dfa.first(_buf[i - 1]) & tkn_dfa_t::F_EOL) {
+            return _run(i, false, handler);
+        }
+    }
+
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool chunk_tknzr_t::finish(const handler_t & handler)
+{
+    const bool ret = _run(_buf.size(), true, handler);
+
+    reset();
+
+    return ret;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void chunk_tknzr_t::reset() noexcept
+{
+    _buf.clear();
+    _resume = 0;
+    _line = 0;
+    _comment_lines = 0;
+    _comment_skip = 0;
+    _tknzr.reset(string_view_t());
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool chunk_tknzr_t::_run(size_t len, bool last, const handler_t & handler)
+{
+    const char_t* text = _buf.data();
+
+    _tknzr.reset(string_view_t(text, len));
+    _tknzr._line = _line;
+    _tknzr._partial = !last;
+    _tknzr.skip(text + _resume);
+    _tknzr._comment_lines = _comment_lines;
+    _tknzr._comment_skip = _comment_skip;
+
+    token_view_t tkn;
+
+    while (_tknzr.next(tkn)) {
+        handler(tkn);
+    }
+
+    if (last) {
+        return _tknzr.eos();
+    }
+
+    // Drop the tokenized lines; if a multi-line comment is still open,
+    // its first line is kept so that token offsets stay right
+    const size_t line_begin = size_t(_tknzr._line_begin - text);
+
+    _resume = size_t(_tknzr._pos - _tknzr._line_begin);
+    _line = _tknzr._line;
+    _comment_lines = _tknzr._comment_lines;
+    _comment_skip = _tknzr._comment_skip;
+    _buf.erase(0, line_begin);
+
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+} // namespace mip
+
+
+/* -------------------------------------------------------------------------- */
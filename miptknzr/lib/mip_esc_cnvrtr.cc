@@ -35,7 +35,7 @@ void esc_cnvrtr_t::_tail(string_t & str, size_t cnt)
 
 /* -------------------------------------------------------------------------- */
 
-bool esc_cnvrtr_t::_octal2dec(const string_t & str, unsigned int& res, size_t & cnt)
+bool esc_cnvrtr_t::_octal2dec(string_view_t str, unsigned int& res, size_t & cnt)
 {
     if (str.size() < 2) {
         return false;
@@ -64,42 +64,40 @@ bool esc_cnvrtr_t::_octal2dec(const string_t & str, unsigned int& res, size_t &
 
 /* -------------------------------------------------------------------------- */
 
-bool esc_cnvrtr_t::_hex2dec(const string_t & str, unsigned int& res, size_t & cnt)
+bool esc_cnvrtr_t::_hex2dec(string_view_t str, unsigned int& res, size_t & cnt)
 {
     if (str.size() < 2 || (str[0] != 'x' && str[0] != 'X')) {
         return false;
     }
 
-    cnt = str.size();
-    string_t hex = str.substr(1, cnt - 1);
+    const string_view_t hex = str.substr(1);
 
     size_t i = 0;
-    for (; i < cnt; ++i) {
+    res = 0;
+
+    for (; i < hex.size(); ++i) {
         const auto ch = ::tolower(hex[i]);
 
-        bool ok = (ch >= _T('0') && ch <= _T('9')) || 
-                  (ch >= _T('a') && ch < _T('f'));
-        if (!ok)
+        if (ch >= _T('0') && ch <= _T('9')) {
+            res = (res << 4) | unsigned(ch - _T('0'));
+        }
+        else if (ch >= _T('a') && ch <= _T('f')) {
+            res = (res << 4) | unsigned(ch - _T('a') + 10);
+        }
+        else {
             break;
+        }
     }
 
-    hex = hex.substr(0, i);
     cnt = i + 1;
 
-    try {
-        res = std::stoi(hex, 0, 16);
-    }
-    catch (std::exception&) {
-        return false;
-    }
-
-    return true;
+    return i > 0;
 }
 
 
 /* -------------------------------------------------------------------------- */
 
-bool esc_cnvrtr_t::convert(const string_t& str, size_t & rcnt, char_t & ch) const
+bool esc_cnvrtr_t::convert(string_view_t str, size_t & rcnt, char_t & ch) const
 {
     if (str.size() <= 1) {
         return false;
@@ -147,7 +145,7 @@ bool esc_cnvrtr_t::convert(const string_t& str, size_t & rcnt, char_t & ch) cons
     default:
         if (str.size() >= 3 && (str[1] >= _T('0') && str[1] <= _T('7'))) {
             unsigned int res = 0;
-            const bool ok = _octal2dec(str.c_str() + 1, res, rcnt);
+            const bool ok = _octal2dec(str.substr(1), res, rcnt);
 
             if (!ok) {
                 return false;
@@ -160,7 +158,7 @@ bool esc_cnvrtr_t::convert(const string_t& str, size_t & rcnt, char_t & ch) cons
         }
         else if (str.size() >= 2 && (str[1] == _T('x') || str[1] == _T('X'))) {
             unsigned int res = 0;
-            const bool ok = _hex2dec(str.c_str() + 1, res, rcnt);
+            const bool ok = _hex2dec(str.substr(1), res, rcnt);
 
             if (!ok) {
                 return false;
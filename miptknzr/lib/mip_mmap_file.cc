@@ -0,0 +1,198 @@
+//
+// This file is part of MipTknzr Library Project
+// Copyright (c) Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.
+// Licensed under the MIT License.
+// See COPYING file in the project root for full license information.
+//
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "../include/mip_mmap_file.h"
+
+#include <fstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+/* -------------------------------------------------------------------------- */
+
+namespace mip {
+
+
+/* -------------------------------------------------------------------------- */
+
+bool mmap_file_t::_read(const std::string& file_name)
+{
+    std::ifstream is(file_name, std::ios::in | std::ios::binary);
+
+    if (!is.is_open()) {
+        return false;
+    }
+
+    is.seekg(0, std::ios::end);
+    const auto size = is.tellg();
+    is.seekg(0, std::ios::beg);
+
+    if (size < 0) {
+        return false;
+    }
+
+    // Keep at least one byte so that data() is never null for an open file
+    _buf.resize(size_t(size) + 1);
+
+    if (size > 0 && !is.read(_buf.data(), size)) {
+        _buf.clear();
+        return false;
+    }
+
+    _buf[size_t(size)] = 0;
+    _data = _buf.data();
+    _size = size_t(size);
+
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifdef _WIN32
+
+bool mmap_file_t::open(const std::string& file_name)
+{
+    close();
+
+    HANDLE file = CreateFileA(
+        file_name.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr);
+
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER size = { 0 };
+
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return _read(file_name);
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    const void* data = mapping ?
+        MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+    if (!data) {
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+
+        CloseHandle(file);
+        return _read(file_name);
+    }
+
+    _file = file;
+    _mapping = mapping;
+    _data = static_cast<const char*>(data);
+    _size = size_t(size.QuadPart);
+    _mapped = true;
+
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void mmap_file_t::close() noexcept
+{
+    if (_mapped) {
+        UnmapViewOfFile(_data);
+        CloseHandle(_mapping);
+        CloseHandle(_file);
+
+        _mapping = nullptr;
+        _file = nullptr;
+    }
+
+    std::vector<char>().swap(_buf);
+    _data = nullptr;
+    _size = 0;
+    _mapped = false;
+}
+
+#else
+
+
+/* -------------------------------------------------------------------------- */
+
+bool mmap_file_t::open(const std::string& file_name)
+{
+    close();
+
+    const int fd = ::open(file_name.c_str(), O_RDONLY);
+
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        ::close(fd);
+        return _read(file_name);
+    }
+
+    void* data = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+    ::close(fd);
+
+    if (data == MAP_FAILED) {
+        return _read(file_name);
+    }
+
+    madvise(data, size_t(st.st_size), MADV_SEQUENTIAL);
+
+    _data = static_cast<const char*>(data);
+    _size = size_t(st.st_size);
+    _mapped = true;
+
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void mmap_file_t::close() noexcept
+{
+    if (_mapped) {
+        munmap(const_cast<char*>(_data), _size);
+    }
+
+    std::vector<char>().swap(_buf);
+    _data = nullptr;
+    _size = 0;
+    _mapped = false;
+}
+
+#endif
+
+
+/* -------------------------------------------------------------------------- */
+
+} // namespace mip
+
+
+/* -------------------------------------------------------------------------- */
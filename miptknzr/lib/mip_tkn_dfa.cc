@@ -0,0 +1,343 @@
+//
+// This file is part of MipTknzr Library Project
+// Copyright (c) Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.
+// Licensed under the MIT License.
+// See COPYING file in the project root for full license information.
+//
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "../include/mip_tkn_dfa.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__)
+#define MIP_TKN_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIP_TKN_SSE2
+#include <emmintrin.h>
+#endif
+
+#if (defined(MIP_TKN_AVX2) || defined(MIP_TKN_SSE2)) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+/* -------------------------------------------------------------------------- */
+
+namespace mip {
+
+
+/* -------------------------------------------------------------------------- */
+
+#if defined(MIP_TKN_AVX2) || defined(MIP_TKN_SSE2)
+
+// Index of the lowest bit set (mask != 0)
+static inline unsigned first_bit(uint32_t mask) noexcept
+{
+#ifdef _MSC_VER
+    unsigned long index = 0;
+    _BitScanForward(&index, mask);
+    return unsigned(index);
+#else
+    return unsigned(__builtin_ctz(mask));
+#endif
+}
+
+#endif
+
+
+/* -------------------------------------------------------------------------- */
+
+void tkn_dfa_t::compile(
+    const std::set<string_t>& blkdef,
+    const std::set<string_t>& atomdef,
+    const std::set<base_tknzr_t::eol_t>& eoldef,
+    const std::set<string_t>& sl_comdef,
+    const std::set<std::pair<string_t, string_t>>& ml_comdef,
+    const std::set<char_t>& quotes)
+{
+    // Build a pointer-free trie first, then lay it out as flat arrays
+    struct tmp_node_t {
+        std::map<char_t, size_t> next;
+        uint8_t accept = 0;
+        uint32_t ml_end = 0;
+    };
+
+    std::vector<tmp_node_t> trie(1);
+
+    auto insert = [&](const string_t& def, cl_t cl) -> tmp_node_t& {
+        size_t n = 0;
+
+        for (const auto ch : def) {
+            auto it = trie[n].next.find(ch);
+
+            if (it == trie[n].next.end()) {
+                trie.emplace_back();
+                it = trie[n].next.emplace(ch, trie.size() - 1).first;
+            }
+
+            n = it->second;
+        }
+
+        trie[n].accept |= uint8_t(1 << uint8_t(cl));
+        return trie[n];
+    };
+
+    _ml_end.clear();
+
+    for (const auto & item : ml_comdef) {
+        if (item.first.empty()) {
+            continue;
+        }
+
+        auto & node = insert(item.first, cl_t::ML_COMMENT);
+
+        // Keep the first end-comment defined for a given prefix
+        if (node.ml_end == 0) {
+            _ml_end.push_back(item.second);
+            node.ml_end = uint32_t(_ml_end.size());
+        }
+    }
+
+    const std::pair<const std::set<string_t>*, cl_t> defs[] = {
+        { &blkdef, cl_t::BLANK },
+        { &sl_comdef, cl_t::SL_COMMENT },
+        { &atomdef, cl_t::ATOM }
+    };
+
+    for (const auto & def : defs) {
+        for (const auto & item : *def.first) {
+            if (!item.empty()) {
+                insert(item, def.second);
+            }
+        }
+    }
+
+    // Flatten the trie: children of a node are contiguous in _edges
+    _nodes.assign(trie.size(), node_t());
+    _edges.clear();
+
+    for (size_t n = 0; n < trie.size(); ++n) {
+        auto & node = _nodes[n];
+
+        node.accept = trie[n].accept;
+        node.ml_end = trie[n].ml_end ? trie[n].ml_end - 1 : 0;
+        node.edge_begin = uint32_t(_edges.size());
+
+        for (const auto & child : trie[n].next) {
+            _edges.push_back(edge_t{ child.first, uint32_t(child.second) });
+        }
+
+        node.edge_end = uint32_t(_edges.size());
+    }
+
+    // Dispatch table
+    std::fill(std::begin(_first), std::end(_first), uint8_t(0));
+    std::fill(std::begin(_root), std::end(_root), uint32_t(0));
+
+    // Flags of a child are the classes of all the definitions below it
+    std::vector<uint8_t> below(trie.size(), 0);
+
+    for (size_t n = trie.size(); n-- > 0;) {
+        below[n] |= trie[n].accept;
+
+        for (const auto & child : trie[n].next) {
+            below[n] |= below[child.second];
+        }
+    }
+
+    for (const auto & child : trie[0].next) {
+        const auto i = _index(child.first);
+
+        _first[i] |= below[child.second];
+
+        if (i < TABLE_SIZE - 1) {
+            _root[i] = uint32_t(child.second);
+        }
+    }
+
+    for (const auto quote : quotes) {
+        _first[_index(quote)] |= F_STRING;
+    }
+
+    for (const auto eol : eoldef) {
+        _first[_index(eol == base_tknzr_t::eol_t::CR ? _T('\r') : _T('\n'))] |= F_EOL;
+    }
+
+    // Characters compared in parallel by skip_other()
+    std::memset(_stop_vec, 0, sizeof(_stop_vec));
+    _stop_cnt = 0;
+
+    if (sizeof(char_t) == 1) {
+        for (size_t i = 0; i < TABLE_SIZE - 1; ++i) {
+            if (!(_first[i] & ~F_EOL)) {
+                continue;
+            }
+
+            if (_stop_cnt == MAX_STOP) {
+                _stop_cnt = 0;
+                break;
+            }
+
+            std::memset(_stop_vec[_stop_cnt++], int(i), STOP_VEC_SIZE);
+        }
+
+        for (; _stop_cnt % 4; ++_stop_cnt) {
+            std::memcpy(_stop_vec[_stop_cnt], _stop_vec[0], STOP_VEC_SIZE);
+        }
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool tkn_dfa_t::match(
+    const char_t* p,
+    const char_t* end,
+    match_t & m) const noexcept
+{
+    const auto i = _index(*p);
+
+    uint32_t n = i < TABLE_SIZE - 1 ? _root[i] : _child(_nodes[0], *p);
+
+    if (!n) {
+        return false;
+    }
+
+    size_t len[size_t(cl_t::CL_CNT)] = { 0 };
+
+    for (size_t cnt = 1; n; ++cnt) {
+        const auto & node = _nodes[n];
+
+        if (node.accept) {
+            // Multi-line comments have top priority and the shortest
+            // prefix wins, so there is no point in going further
+            if (node.accept & F_ML_COMMENT) {
+                m.cl = cl_t::ML_COMMENT;
+                m.len = cnt;
+                m.end_comment = &_ml_end[node.ml_end];
+                return true;
+            }
+
+            for (size_t cl = 0; cl < size_t(cl_t::CL_CNT); ++cl) {
+                if (node.accept & (1 << cl)) {
+                    len[cl] = cnt;
+                }
+            }
+        }
+
+        n = p + cnt < end ? _child(node, p[cnt]) : 0;
+    }
+
+    for (size_t cl = 0; cl < size_t(cl_t::CL_CNT); ++cl) {
+        if (len[cl]) {
+            m.cl = cl_t(cl);
+            m.len = len[cl];
+            m.end_comment = nullptr;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+const char_t* tkn_dfa_t::skip_other(
+    const char_t* p,
+    const char_t* end) const noexcept
+{
+    if (_stop_cnt) {
+        p = _skip_other_simd(p, end);
+    }
+
+    while (p < end && !(first(*p) & ~F_EOL)) {
+        ++p;
+    }
+
+    return p;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+// Skip whole blocks of characters which cannot begin a definition; the
+// remaining tail (shorter than a block) is left to skip_other()
+const char_t* tkn_dfa_t::_skip_other_simd(
+    const char_t* p,
+    const char_t* end) const noexcept
+{
+#if defined(MIP_TKN_AVX2)
+    while (end - p >= 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i hit = _mm256_setzero_si256();
+
+        for (size_t i = 0; i < _stop_cnt; i += 4) {
+            const auto row = reinterpret_cast<const __m128i*>(_stop_vec[i]);
+
+            const __m256i hit01 = _mm256_or_si256(
+                _mm256_cmpeq_epi8(v, _mm256_broadcastsi128_si256(_mm_load_si128(row))),
+                _mm256_cmpeq_epi8(v, _mm256_broadcastsi128_si256(_mm_load_si128(row + 1))));
+
+            const __m256i hit23 = _mm256_or_si256(
+                _mm256_cmpeq_epi8(v, _mm256_broadcastsi128_si256(_mm_load_si128(row + 2))),
+                _mm256_cmpeq_epi8(v, _mm256_broadcastsi128_si256(_mm_load_si128(row + 3))));
+
+            hit = _mm256_or_si256(hit, _mm256_or_si256(hit01, hit23));
+        }
+
+        const uint32_t mask = uint32_t(_mm256_movemask_epi8(hit));
+
+        if (mask) {
+            return p + first_bit(mask);
+        }
+
+        p += 32;
+    }
+#elif defined(MIP_TKN_SSE2)
+    while (end - p >= 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i hit = _mm_setzero_si128();
+
+        for (size_t i = 0; i < _stop_cnt; i += 4) {
+            const auto row = reinterpret_cast<const __m128i*>(_stop_vec[i]);
+
+            const __m128i hit01 = _mm_or_si128(
+                _mm_cmpeq_epi8(v, _mm_load_si128(row)),
+                _mm_cmpeq_epi8(v, _mm_load_si128(row + 1)));
+
+            const __m128i hit23 = _mm_or_si128(
+                _mm_cmpeq_epi8(v, _mm_load_si128(row + 2)),
+                _mm_cmpeq_epi8(v, _mm_load_si128(row + 3)));
+
+            hit = _mm_or_si128(hit, _mm_or_si128(hit01, hit23));
+        }
+
+        const uint32_t mask = uint32_t(_mm_movemask_epi8(hit));
+
+        if (mask) {
+            return p + first_bit(mask);
+        }
+
+        p += 16;
+    }
+#else
+    (void)end;
+#endif
+
+    return p;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+} // namespace mip
+
+
+/* -------------------------------------------------------------------------- */
@@ -22,42 +22,6 @@
 namespace mip {
 
 
-/* -------------------------------------------------------------------------- */
-
-bool tknzr_t::_is_prefix_ch(const char_t ch, const std::set<string_t> & tknset)
-{
-    for (const auto & item : tknset) {
-        if (!item.empty() && item[0] == ch) {
-            return true;
-        }
-    }
-
-    return false;
-}
-
-
-/* -------------------------------------------------------------------------- */
-
-std::set<string_t>::const_reverse_iterator tknzr_t::_search_token(
-    const std::set<string_t>& tknset,
-    string_t & line)
-{
-    auto it = tknset.rbegin();
-
-    for (; it != tknset.rend(); ++it) {
-        auto & tkn = *it;
-
-        if (tkn.size() <= line.size()) {
-            if (line.substr(0, tkn.size()) == tkn) {
-                return it;
-            }
-        }
-    }
-
-    return it;
-}
-
-
 /* -------------------------------------------------------------------------- */
 
 string_t tknzr_t::_extract_token(
@@ -85,8 +49,8 @@ string_t tknzr_t::_extract_token(
 bool tknzr_t::_getline(
     _istream & is, string_t & line, string_t& eol_s, bool & eof)
 {
-    const bool cr = _eoldef.find(base_tknzr_t::eol_t::CR) != _eoldef.end();
-    const bool lf = _eoldef.find(base_tknzr_t::eol_t::LF) != _eoldef.end();
+    const bool cr = _def->has_eol(base_tknzr_t::eol_t::CR);
+    const bool lf = _def->has_eol(base_tknzr_t::eol_t::LF);
 
     _stringstream ss;
 
@@ -205,69 +169,30 @@ std::unique_ptr<token_t> tknzr_t::_search_other_tkn()
 /* -------------------------------------------------------------------------- */
 
 std::unique_ptr<token_t> tknzr_t::_get_tkn(
-    const std::set<string_t> & tknset,
+    size_t len,
     token_t::tcl_t tkncl,
     get_t cut_type)
 {
-    if (_is_prefix_ch(_textline[0], tknset)) {
-
-        auto it = _search_token(tknset, _textline);
-
-        if (it != tknset.rend()) {
-
-            auto tkn = _search_other_tkn();
-            if (tkn) {
-                return tkn;
-            }
-
-            auto token = *it;
-
-            if (cut_type == get_t::WHOLE_LN) {
-                token = _textline;
-                _textline.clear();
-            }
-            else {
-                _textline = 
-                    _textline.substr(
-                        token.size(), 
-                        _textline.size() - token.size());
-            }
-
-            auto token_obj = new token_t(
-                tkncl,
-                token,
-                _line_number,
-                _offset);
-
-            _offset += token.size();
+    string_t token;
 
-            return std::unique_ptr<token_t>(token_obj);
-        }
+    if (cut_type == get_t::WHOLE_LN) {
+        token = _textline;
+        _textline.clear();
+    }
+    else {
+        token = _textline.substr(0, len);
+        _textline.erase(0, len);
     }
 
-    return nullptr;
-}
-
-
-/* -------------------------------------------------------------------------- */
+    auto token_obj = new token_t(
+        tkncl,
+        token,
+        _line_number,
+        _offset);
 
-bool tknzr_t::_ml_comment_begin( 
-    const std::set<ml_commdef_t> & tknset,
-    string_t& end_comment)
-{
-    for (const auto & item : tknset) {
-        
-        const auto& prefix = item.first;
+    _offset += token.size();
 
-        if (prefix.size() <= _textline.size() &&
-            _textline.substr(0, prefix.size()) == prefix) 
-        {
-            end_comment = item.second;
-            return true;
-        }
-    }
-
-    return false;
+    return std::unique_ptr<token_t>(token_obj);
 }
 
 
@@ -280,9 +205,9 @@ std::unique_ptr<token_t> tknzr_t::_get_string()
     }
 
     const auto quote_ch = _textline[0];
-    auto quote_esc_it = _strdef.find(quote_ch);
+    auto quote_esc_it = _def->str_def().find(quote_ch);
 
-    if (quote_esc_it == _strdef.end()) {
+    if (quote_esc_it == _def->str_def().end()) {
         return nullptr;
     }
 
@@ -303,13 +228,20 @@ std::unique_ptr<token_t> tknzr_t::_get_string()
 
         if (esc_cnvt && ch == esc_ch) {
             size_t remove_cnt = 0;
-            if (!esc_cnvt->convert(_textline.c_str() + i, remove_cnt, ch)) {
+            if (!esc_cnvt->convert(string_view_t(_textline).substr(i), remove_cnt, ch)) {
                 return nullptr;
             }
             i += (remove_cnt - 1);
             extra_ch_cnt += (remove_cnt - 1);
         }
         else if (ch == quote_ch) {
+            // a pending other token precedes the string
+            auto tkn = _search_other_tkn();
+
+            if (tkn) {
+                return tkn;
+            }
+
             const auto str = ss.str();
 
             auto token_obj = new token_t(
@@ -384,22 +316,42 @@ tknzr_t::_extract_comment(
 
 /* -------------------------------------------------------------------------- */
 
-std::unique_ptr<token_t> tknzr_t::_get_comment(_istream & is)
+std::unique_ptr<token_t> tknzr_t::_get_comment(
+    _istream & is,
+    string_t& end_comment)
 {
     string_t comment;
-    string_t end_comment;
 
     const size_t comment_line = _line_number;
     const size_t comment_offset = _offset;
 
-    if (_ml_comment_begin(_ml_comdef, end_comment)) {
-        auto tkn = _search_other_tkn();
+    size_t end_comment_offset = _textline.find(end_comment);
 
-        if (tkn) {
-            return tkn;
+    auto tkn = _extract_comment(
+        comment, 
+        end_comment_offset, 
+        end_comment,
+        comment_line,
+        comment_offset);
+
+    if (tkn) {
+        return tkn;
+    }
+
+    while (!_eof && end_comment_offset == string_t::npos) {
+        comment += _textline;
+        comment += _eol_seq;
+        
+        ++_line_number;
+        _offset = 0;
+        _textline.clear();
+        _eol_seq.clear();
+
+        if (!_getline(is, _textline, _eol_seq, _eof)) {
+            return nullptr;
         }
 
-        size_t end_comment_offset = _textline.find(end_comment);
+        end_comment_offset = _textline.find(end_comment);
 
         tkn = _extract_comment(
             comment, 
@@ -411,37 +363,18 @@ std::unique_ptr<token_t> tknzr_t::_get_comment(_istream & is)
         if (tkn) {
             return tkn;
         }
-
-        bool eof = false;
-        while (!eof && end_comment_offset == string_t::npos) {
-            comment += _textline;
-            comment += _eol_seq;
-            
-            ++_line_number;
-            _offset = 0;
-            _textline.clear();
-            _eol_seq.clear();
-
-            if (!_getline(is, _textline, _eol_seq, eof)) {
-                return nullptr;
-            }
-
-            end_comment_offset = _textline.find(end_comment);
-
-            tkn = _extract_comment(
-                comment, 
-                end_comment_offset, 
-                end_comment,
-                comment_line,
-                comment_offset);
-
-            if (tkn) {
-                return tkn;
-            }
-        }
     }
 
-    return nullptr;
+    // unterminated comment: it extends up to the end of text
+    comment += _textline;
+    _offset += _textline.size();
+    _textline.clear();
+
+    return std::unique_ptr<token_t>(new token_t(
+        token_t::tcl_t::COMMENT,
+        comment,
+        comment_line,
+        comment_offset));
 }
 
 
@@ -481,50 +414,78 @@ std::unique_ptr<token_t> tknzr_t::next(_istream & is)
                 _reset();
                 return nullptr;
             }
-        }
 
-        // multi-line commment
-        auto tkn = _get_comment(is);
-        if (tkn) {
-            return tkn;
+            if (_textline.empty()) {
+                continue;
+            }
         }
 
-        // blank
-        tkn = _get_tkn(_blkdef, token_t::tcl_t::BLANK, get_t::JUST_TKN);
+        const auto first = _dfa().first(_textline[0]);
 
-        if (tkn) {
-            return tkn;
+        // Characters which cannot begin any definition are appended to
+        // the other token buffer as a whole run
+        if (!(first & ~tkn_dfa_t::F_EOL)) {
+            const char_t* text = _textline.data();
+            const size_t len = size_t(
+                _dfa().skip_other(text + 1, text + _textline.size()) - text);
+
+            _other_token.append(_textline, 0, len);
+            _textline.erase(0, len);
+            continue;
         }
 
-        // single-line comment
-        tkn = _get_tkn(_sl_comdef, token_t::tcl_t::COMMENT, get_t::WHOLE_LN);
+        tkn_dfa_t::match_t m;
 
-        if (tkn) {
-            return tkn;
-        }
+        // multi-line comment, blank, single-line comment or atom
+        if (_dfa().match(
+            _textline.data(), _textline.data() + _textline.size(), m)) 
+        {
+            auto tkn = _search_other_tkn();
+
+            if (tkn) {
+                return tkn;
+            }
 
-        // atomic token
-        tkn = _get_tkn(_atomdef, token_t::tcl_t::ATOM, get_t::JUST_TKN);
+            switch (m.cl) {
+            case tkn_dfa_t::cl_t::ML_COMMENT: {
+                string_t end_comment = *m.end_comment;
+                tkn = _get_comment(is, end_comment);
+                break;
+            }
 
-        if (tkn) {
-            return tkn;
+            case tkn_dfa_t::cl_t::BLANK:
+                tkn = _get_tkn(m.len, token_t::tcl_t::BLANK, get_t::JUST_TKN);
+                break;
+
+            case tkn_dfa_t::cl_t::SL_COMMENT:
+                tkn = _get_tkn(m.len, token_t::tcl_t::COMMENT, get_t::WHOLE_LN);
+                break;
+
+            default:
+                tkn = _get_tkn(m.len, token_t::tcl_t::ATOM, get_t::JUST_TKN);
+                break;
+            }
+
+            if (tkn) {
+                return tkn;
+            }
+
+            // error reading a multi-line comment
+            break;
         }
 
         // string
-        tkn = _get_string();
+        if (first & tkn_dfa_t::F_STRING) {
+            auto tkn = _get_string();
 
-        if (tkn) {
-            return tkn;
+            if (tkn) {
+                return tkn;
+            }
         }
 
         // append to other token buffer 
-        if (!_textline.empty()) {
-            _other_token += _textline[0];
-
-            _textline =
-                _textline.size() == 1 ? _T("") :
-                _textline.substr(1, _textline.size() - 1);
-        }
+        _other_token += _textline[0];
+        _textline.erase(0, 1);
     }
 
     _reset();
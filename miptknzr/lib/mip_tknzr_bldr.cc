@@ -22,19 +22,29 @@ namespace mip {
 
 /* -------------------------------------------------------------------------- */
 
-bool tknzr_bldr_t::_build_tknzr()
+tknzr_def_t& tknzr_bldr_t::_edit_def()
 {
-    if (!_tknzr) {
-        _tknzr.reset(new tknzr_t());
+    // A compiled definition may be shared by tokenizers: further
+    // definitions go to a new copy
+    if (_compiled) {
+        _def = std::make_shared<tknzr_def_t>(*_def);
+        _compiled.reset();
+    }
+
+    return *_def;
+}
 
-        assert(_tknzr);
 
-        if (!_tknzr) {
-            return false;
-        }
+/* -------------------------------------------------------------------------- */
+
+tknzr_def_ptr_t tknzr_bldr_t::build_def()
+{
+    if (!_compiled) {
+        _def->_compile();
+        _compiled = _def;
     }
 
-    return true;
+    return _compiled;
 }
 
 
@@ -42,7 +52,23 @@ bool tknzr_bldr_t::_build_tknzr()
 
 std::unique_ptr< base_tknzr_t > tknzr_bldr_t::build()
 {
-    return std::move(_tknzr);
+    return std::unique_ptr< base_tknzr_t >(new tknzr_t(build_def()));
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+std::unique_ptr< buf_tknzr_t > tknzr_bldr_t::build_buf()
+{
+    return std::unique_ptr< buf_tknzr_t >(new buf_tknzr_t(build_def()));
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+std::unique_ptr< chunk_tknzr_t > tknzr_bldr_t::build_chunk()
+{
+    return std::unique_ptr< chunk_tknzr_t >(new chunk_tknzr_t(build_def()));
 }
 
 
@@ -50,7 +76,7 @@ std::unique_ptr< base_tknzr_t > tknzr_bldr_t::build()
 
 bool tknzr_bldr_t::def_atom(const string_t& value)
 {
-    return _def_item(value, _tknzr->_atomdef);
+    return _def_item(value, _edit_def()._atomdef);
 }
 
 
@@ -58,7 +84,7 @@ bool tknzr_bldr_t::def_atom(const string_t& value)
 
 bool tknzr_bldr_t::def_atom(const std::set<string_t>& value_set)
 {
-    return _def_item(value_set, _tknzr->_atomdef);
+    return _def_item(value_set, _edit_def()._atomdef);
 }
 
 
@@ -66,7 +92,7 @@ bool tknzr_bldr_t::def_atom(const std::set<string_t>& value_set)
 
 bool tknzr_bldr_t::def_blank(const string_t& value)
 {
-    return _def_item(value, _tknzr->_blkdef);
+    return _def_item(value, _edit_def()._blkdef);
 }
 
 
@@ -74,7 +100,7 @@ bool tknzr_bldr_t::def_blank(const string_t& value)
 
 bool tknzr_bldr_t::def_blank(const std::set<string_t>& value_set)
 {
-    return _def_item(value_set, _tknzr->_blkdef);
+    return _def_item(value_set, _edit_def()._blkdef);
 }
 
 
@@ -82,7 +108,7 @@ bool tknzr_bldr_t::def_blank(const std::set<string_t>& value_set)
 
 bool tknzr_bldr_t::def_eol(const base_tknzr_t::eol_t& value)
 {
-    return _def_item(value, _tknzr->_eoldef);
+    return _def_item(value, _edit_def()._eoldef);
 }
 
 
@@ -90,7 +116,7 @@ bool tknzr_bldr_t::def_eol(const base_tknzr_t::eol_t& value)
 
 bool tknzr_bldr_t::def_eol(const std::set<base_tknzr_t::eol_t>& value_set)
 {
-    return _def_item(value_set, _tknzr->_eoldef);
+    return _def_item(value_set, _edit_def()._eoldef);
 }
 
 
@@ -98,7 +124,7 @@ bool tknzr_bldr_t::def_eol(const std::set<base_tknzr_t::eol_t>& value_set)
 
 bool tknzr_bldr_t::def_sl_comment(const string_t& prefix)
 {
-    return _def_item(prefix, _tknzr->_sl_comdef);
+    return _def_item(prefix, _edit_def()._sl_comdef);
 }
 
 
@@ -106,7 +132,7 @@ bool tknzr_bldr_t::def_sl_comment(const string_t& prefix)
 
 bool tknzr_bldr_t::def_sl_comment(const std::set<string_t>& prefix_set)
 {
-    return _def_item(prefix_set, _tknzr->_sl_comdef);
+    return _def_item(prefix_set, _edit_def()._sl_comdef);
 }
 
 
@@ -117,7 +143,7 @@ bool tknzr_bldr_t::def_ml_comment(
     const string_t& end)
 {
     std::pair<string_t, string_t> value{ begin, end };
-    return _def_item(value, _tknzr->_ml_comdef);
+    return _def_item(value, _edit_def()._ml_comdef);
 }
 
 
@@ -125,12 +151,14 @@ bool tknzr_bldr_t::def_ml_comment(
 
 bool tknzr_bldr_t::def_string(char_t quote, std::shared_ptr<base_esc_cnvrtr_t> et)
 {
-    auto it = _tknzr->_strdef.find(quote);
-    if (it != _tknzr->_strdef.end()) {
+    auto & strdef = _edit_def()._strdef;
+
+    auto it = strdef.find(quote);
+    if (it != strdef.end()) {
         return false;
     }
 
-    _tknzr->_strdef[quote] = et;
+    strdef[quote] = et;
 
     return true;
 }
@@ -0,0 +1,42 @@
+//
+// This file is part of MipTknzr Library Project
+// Copyright (c) Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.
+// Licensed under the MIT License.
+// See COPYING file in the project root for full license information.
+//
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "../include/mip_tknzr_def.h"
+
+
+/* -------------------------------------------------------------------------- */
+
+namespace mip {
+
+
+/* -------------------------------------------------------------------------- */
+
+void tknzr_def_t::_compile()
+{
+    std::set<char_t> quotes;
+
+    for (const auto & item : _strdef) {
+        quotes.insert(item.first);
+    }
+
+    _eol_cr = _eoldef.find(base_tknzr_t::eol_t::CR) != _eoldef.end();
+    _eol_lf = _eoldef.find(base_tknzr_t::eol_t::LF) != _eoldef.end();
+
+    _dfa.compile(_blkdef, _atomdef, _eoldef, _sl_comdef, _ml_comdef, quotes);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+} // namespace mip
+
+
+/* -------------------------------------------------------------------------- */
@@ -1,30 +1,30 @@
-//{{NO_DEPENDENCIES}}
-// Microsoft Visual C++ generated include file.
-// Used by WinRayCast.rc
-//
-#define IDC_MYICON                      2
-#define IDD_WINRAYCAST_DIALOG           102
-#define IDD_ABOUTBOX                    103
-#define IDS_APP_TITLE                   103
-#define IDM_ABOUT                       104
-#define IDM_EXIT                        105
-#define IDS_HELLO                       106
-#define IDI_WINRAYCAST                  107
-#define IDI_SMALL                       108
-#define IDC_WINRAYCAST                  109
-#define IDR_MAINFRAME                   128
-#define IDB_BITMAP1                     131
-#define ID_FILE_ABOUT                   32797
-#define ID_FILE_INFO                    32798
-#define IDC_STATIC                      -1
-
-// Next default values for new objects
-// 
-#ifdef APSTUDIO_INVOKED
-#ifndef APSTUDIO_READONLY_SYMBOLS
-#define _APS_NEXT_RESOURCE_VALUE        133
-#define _APS_NEXT_COMMAND_VALUE         32799
-#define _APS_NEXT_CONTROL_VALUE         1000
-#define _APS_NEXT_SYMED_VALUE           110
-#endif
-#endif
+//{{NO_DEPENDENCIES}}
+// Microsoft Visual C++ generated include file.
+// Used by WinRayCast.rc
+//
+#define IDC_MYICON                      2
+#define IDD_WINRAYCAST_DIALOG           102
+#define IDD_ABOUTBOX                    103
+#define IDS_APP_TITLE                   103
+#define IDM_ABOUT                       104
+#define IDM_EXIT                        105
+#define IDS_HELLO                       106
+#define IDI_WINRAYCAST                  107
+#define IDI_SMALL                       108
+#define IDC_WINRAYCAST                  109
+#define IDR_MAINFRAME                   128
+#define IDB_BITMAP1                     131
+#define ID_FILE_ABOUT                   32797
+#define ID_FILE_INFO                    32798
+#define IDC_STATIC                      -1
+
+// Next default values for new objects
+// 
+#ifdef APSTUDIO_INVOKED
+#ifndef APSTUDIO_READONLY_SYMBOLS
+#define _APS_NEXT_RESOURCE_VALUE        133
+#define _APS_NEXT_COMMAND_VALUE         32799
+#define _APS_NEXT_CONTROL_VALUE         1000
+#define _APS_NEXT_SYMED_VALUE           110
+#endif
+#endif
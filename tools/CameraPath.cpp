@@ -0,0 +1,195 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "CameraPath.h"
+
+#include <fstream>
+#include <math.h>
+#include <sstream>
+
+
+/* -------------------------------------------------------------------------- */
+
+// Built-in path of res/world.ini (see CameraPath::setDefault)
+static const char DEFAULT_PATH[] =
+    "# frame  col   row   angle  slope   center\n"
+    "  0      4.5   4.5   0      0       0.5\n"
+    "  119    4.5   4.5   360    0       0.5\n"
+    "  139    4.5   4.5   360    0.25    0.5\n"
+    "  179    4.5   4.5   360   -0.25    0.5\n"
+    "  199    4.5   4.5   360    0       0.5\n"
+    "  219    4.5   4.5   360    0       0.1\n"
+    "  239    4.5   4.5   360    0       0.9\n"
+    "  249    4.5   4.5   360    0       0.5\n"
+    "  279    3.5   5.5   450    0       0.5\n"
+    "  359    3.5   9.5   450    0       0.5\n"
+    "  399    3.5   12.5  450    0       0.5\n"
+    "  439    3.5   12.5  630    0       0.5\n"
+    "  499    3.5   7.5   630    0       0.5\n";
+
+
+/* -------------------------------------------------------------------------- */
+
+bool CameraPath::load(const std::string& fileName)
+{
+    std::ifstream is(fileName);
+
+    if (!is.is_open()) {
+        m_lastError = "cannot open " + fileName;
+        return false;
+    }
+
+    if (!parse(is)) {
+        m_lastError = fileName + ": " + m_lastError;
+        return false;
+    }
+
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool CameraPath::parse(std::istream& is)
+{
+    std::vector<Pose> poses;
+    std::string line;
+    int lineNumber = 0;
+
+    while (std::getline(is, line)) {
+        ++lineNumber;
+
+        const size_t comment = line.find('#');
+
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+
+        std::istringstream ls(line);
+        Pose pose;
+
+        if (!(ls >> pose.frame)) {
+            // Blank line
+            if (ls.eof()) {
+                continue;
+            }
+        }
+        else if (ls >> pose.col >> pose.row >> pose.angle >> pose.slope >> pose.center) {
+            std::string rest;
+
+            const bool ordered = poses.empty() ?
+                pose.frame == 0 :
+                pose.frame > poses.back().frame;
+
+            if (!(ls >> rest) && ordered && pose.center >= 0 && pose.center <= 1) {
+                poses.push_back(pose);
+                continue;
+            }
+        }
+
+        m_lastError = "invalid pose at line " + std::to_string(lineNumber);
+        return false;
+    }
+
+    if (poses.empty()) {
+        m_lastError = "no poses";
+        return false;
+    }
+
+    m_poses = std::move(poses);
+
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void CameraPath::setDefault()
+{
+    std::istringstream is(DEFAULT_PATH);
+
+    parse(is);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+CameraPath::Pose CameraPath::getPose(int frame) const noexcept
+{
+    if (m_poses.empty()) {
+        return Pose{ frame, 0, 0, 0, 0, 0.5 };
+    }
+
+    const int frameCount = getFrameCount();
+
+    frame %= frameCount;
+
+    if (frame < 0) {
+        frame += frameCount;
+    }
+
+    size_t next = 1;
+
+    while (next < m_poses.size() && m_poses[next].frame < frame) {
+        ++next;
+    }
+
+    if (next >= m_poses.size()) {
+        Pose pose = m_poses.back();
+        pose.frame = frame;
+        return pose;
+    }
+
+    const Pose& a = m_poses[next - 1];
+    const Pose& b = m_poses[next];
+    const double t = double(frame - a.frame) / double(b.frame - a.frame);
+
+    auto lerp = [t](double from, double to) {
+        return from + (to - from) * t;
+    };
+
+    return Pose{
+        frame,
+        lerp(a.col, b.col),
+        lerp(a.row, b.row),
+        lerp(a.angle, b.angle),
+        lerp(a.slope, b.slope),
+        lerp(a.center, b.center)
+    };
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void CameraPath::applyTo(int frame, Player& player, const WorldMap& wMap) const noexcept
+{
+    const Pose pose = getPose(frame);
+
+    // Angles are measured in projection columns, a multiple of the
+    // projection width per turn, and the player direction is the one
+    // of the leftmost column
+    const int deg360 = player.deg360();
+    double alpha = fmod(pose.angle, 360.0) * deg360 / 360.0 - player.degHalfVisual();
+
+    if (alpha < 0) {
+        alpha += deg360;
+    }
+
+    player.setPos(std::make_pair(
+        pose.col * wMap.getCellDx(),
+        pose.row * wMap.getCellDy()));
+
+    player.setAlpha(int(alpha + 0.5));
+    player.setSlope(int(floor(pose.slope * player.getYProjRes() + 0.5)));
+    player.setCenterProj(pose.center);
+}
+
+
+/* -------------------------------------------------------------------------- */
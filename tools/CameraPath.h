@@ -0,0 +1,89 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __CAMERAPATH_H__
+#define __CAMERAPATH_H__
+
+#include "../Player.h"
+#include "../WorldMap.h"
+
+#include <istream>
+#include <string>
+#include <vector>
+
+
+/* -------------------------------------------------------------------------- */
+
+// Scripted camera path, replayed frame by frame, so that the same frames
+// are rendered whatever the speed of the machine.
+//
+// A script is a text of key poses, one per line ('#' starts a comment):
+//
+//   frame  col  row  angle  slope  center
+//
+//   frame   frame number the pose is reached at (the first one is 0, the
+//           others increasing)
+//   col,row camera position, in cells (4.5,4.5 is the center of the cell
+//           at column 4, row 4)
+//   angle   direction of the center of the view, in degrees (0 is towards
+//           the increasing columns, 90 towards the increasing rows)
+//   slope   vertical shift of the view, as a fraction of the projection
+//           height (Player::setSlope)
+//   center  height of the eyes, 0 (floor) ... 1 (ceiling), see
+//           Player::setCenterProj
+//
+// The poses of the frames between two key poses are interpolated
+// linearly (an angle going from 0 to 360 is a full turn).
+class CameraPath
+{
+public:
+    struct Pose {
+        int frame;
+        double col;
+        double row;
+        double angle;
+        double slope;
+        double center;
+    };
+
+    // Load a script
+    // @return false on error (see getLastError)
+    bool load(const std::string& fileName);
+    bool parse(std::istream& is);
+
+    // Use the built-in path of res/world.ini: a full turn in the first
+    // room, looking up and down, crouching and jumping, then a walk to
+    // the second room through the door
+    void setDefault();
+
+    // Return the number of frames of the path
+    int getFrameCount() const noexcept {
+        return m_poses.empty() ? 0 : m_poses.back().frame + 1;
+    }
+
+    // Return the pose of a frame (the path is repeated)
+    Pose getPose(int frame) const noexcept;
+
+    // Set the camera to the pose of a frame
+    void applyTo(int frame, Player& player, const WorldMap& wMap) const noexcept;
+
+    const std::string& getLastError() const noexcept {
+        return m_lastError;
+    }
+
+private:
+    std::vector<Pose> m_poses;
+    std::string m_lastError;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif // __CAMERAPATH_H__
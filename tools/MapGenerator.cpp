@@ -0,0 +1,268 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "MapGenerator.h"
+
+#include <stdio.h>
+#include <string.h>
+
+
+/* -------------------------------------------------------------------------- */
+
+// Number of texture images shipped in res/ (01.bmp ... 0e.bmp)
+#define RES_TEXTURE_COUNT 14
+
+// Side (in cells) of the blocks used for open areas and texture themes
+#define AREA_BLOCK_SIZE 8
+
+// The application places the camera in the cell (4,4)
+#define SPAWN_AREA_MIN 1
+#define SPAWN_AREA_MAX 7
+
+
+/* -------------------------------------------------------------------------- */
+
+enum : uint32_t {
+    SALT_WALL = 1,
+    SALT_OPEN_AREA,
+    SALT_WALL_TEXTURE,
+    SALT_HEIGHT,
+    SALT_HEIGHT_TEXTURE,
+    SALT_TRANSP,
+    SALT_TRANSP_TEXTURE,
+    SALT_SKY,
+    SALT_CEIL_TEXTURE,
+    SALT_FLOOR_TEXTURE
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+static uint64_t splitmix64(uint64_t x) noexcept
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+MapGenerator::MapGenerator(const Params& params) noexcept :
+    m_params(params)
+{
+    if (m_params.textureCount < 1) {
+        m_params.textureCount = 1;
+    }
+    else if (m_params.textureCount > 0xfe) {
+        m_params.textureCount = 0xfe;
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+double MapGenerator::random(uint32_t row, uint32_t col, uint32_t salt) const noexcept
+{
+    const uint64_t h = splitmix64(
+        splitmix64((uint64_t(m_params.seed) << 32) | salt) ^
+        ((uint64_t(row) << 32) | col));
+
+    return double(h >> 11) * (1.0 / 9007199254740992.0);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+MapGenerator::Cell MapGenerator::texture(
+    uint32_t row, uint32_t col, uint32_t salt) const noexcept
+{
+    return 1 + Cell(random(row, col, salt) * m_params.textureCount);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool MapGenerator::isSpawnArea(uint32_t row, uint32_t col) const noexcept
+{
+    return row >= SPAWN_AREA_MIN && row <= SPAWN_AREA_MAX &&
+        col >= SPAWN_AREA_MIN && col <= SPAWN_AREA_MAX &&
+        m_params.rows > SPAWN_AREA_MAX + 1 && m_params.cols > SPAWN_AREA_MAX + 1;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+MapGenerator::Cell MapGenerator::cellAt(uint32_t row, uint32_t col) const noexcept
+{
+    const uint32_t brow = row / AREA_BLOCK_SIZE;
+    const uint32_t bcol = col / AREA_BLOCK_SIZE;
+
+    const bool border = row == 0 || col == 0 ||
+        row + 1 >= m_params.rows || col + 1 >= m_params.cols;
+
+    bool wall = border;
+
+    if (!wall && !isSpawnArea(row, col)) {
+        const bool openArea =
+            random(brow, bcol, SALT_OPEN_AREA) < m_params.openAreaRatio;
+
+        wall = !openArea && random(row, col, SALT_WALL) < m_params.wallDensity;
+    }
+
+    if (wall) {
+        // Walls of the same block share the texture theme
+        Cell cell = texture(brow, bcol, SALT_WALL_TEXTURE);
+
+        if (random(row, col, SALT_HEIGHT) < m_params.wallHeightRatio) {
+            cell |= texture(brow, bcol, SALT_HEIGHT_TEXTURE) << 32;
+        }
+
+        return cell;
+    }
+
+    Cell cell = texture(brow, bcol, SALT_FLOOR_TEXTURE) << 16;
+
+    cell |= random(brow, bcol, SALT_SKY) < m_params.skyRatio ?
+        Cell(0xff) << 8 :
+        texture(brow, bcol, SALT_CEIL_TEXTURE) << 8;
+
+    if (!isSpawnArea(row, col) &&
+        random(row, col, SALT_TRANSP) < m_params.transpRatio)
+    {
+        cell |= texture(row, col, SALT_TRANSP_TEXTURE) << 24;
+
+        if (random(row, col, SALT_HEIGHT) < m_params.wallHeightRatio) {
+            cell |= texture(row, col, SALT_HEIGHT_TEXTURE) << 32;
+        }
+    }
+
+    return cell;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+void MapGenerator::generate(std::vector<Cell>& cells) const
+{
+    cells.resize(size_t(m_params.rows) * size_t(m_params.cols));
+
+    size_t i = 0;
+
+    for (uint32_t r = 0; r < m_params.rows; ++r) {
+        for (uint32_t c = 0; c < m_params.cols; ++c) {
+            cells[i++] = cellAt(r, c);
+        }
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+WorldMap::TextureList MapGenerator::getTextureList() const
+{
+    WorldMap::TextureList textureList;
+
+    for (int key = 1; key <= m_params.textureCount; ++key) {
+        char name[16] = { 0 };
+        char image[16] = { 0 };
+
+        snprintf(name, sizeof(name), "%02x", key);
+        snprintf(image, sizeof(image), "%02x", 1 + (key - 1) % RES_TEXTURE_COUNT);
+
+        textureList[name] = image;
+    }
+
+    return textureList;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool MapGenerator::writeText(std::ostream& os) const
+{
+    os << "// World MAP (generated "
+       << m_params.rows << "x" << m_params.cols
+       << ", seed " << m_params.seed << ")\n\nmap {\n";
+
+    // "0200000001 " for each cell
+    std::string line;
+    line.reserve(size_t(m_params.cols) * 11 + 8);
+
+    for (uint32_t r = 0; r < m_params.rows && os; ++r) {
+        line = "    ";
+
+        for (uint32_t c = 0; c < m_params.cols; ++c) {
+            char hex[16] = { 0 };
+            snprintf(hex, sizeof(hex), "%010llx",
+                (unsigned long long)(cellAt(r, c) & 0xffffffffffULL));
+
+            if (c) {
+                line += ' ';
+            }
+
+            line += hex;
+        }
+
+        line += (r + 1 < m_params.rows) ? ",\n" : "\n";
+        os << line;
+    }
+
+    os << "}\n\ntmap {\n";
+
+    for (const auto & item : getTextureList()) {
+        os << "\t" << item.first << " \"" << item.second << "\"\n";
+    }
+
+    os << "}\n";
+
+    return bool(os);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool MapGenerator::writeBinary(std::ostream& os) const
+{
+    const auto textureList = getTextureList();
+
+    WorldMap::BinaryHeader hdr = { { 0 } };
+
+    memcpy(hdr.magic, WorldMap::binaryMagic(), sizeof(hdr.magic));
+    hdr.rows = m_params.rows;
+    hdr.cols = m_params.cols;
+    hdr.textures = uint32_t(textureList.size());
+
+    os.write((const char*)&hdr, sizeof(hdr));
+
+    std::vector<Cell> row(m_params.cols);
+
+    for (uint32_t r = 0; r < m_params.rows && os; ++r) {
+        for (uint32_t c = 0; c < m_params.cols; ++c) {
+            row[c] = cellAt(r, c);
+        }
+
+        os.write((const char*)row.data(), row.size() * sizeof(Cell));
+    }
+
+    auto writeString = [&os](const std::string& str) {
+        const uint32_t len = uint32_t(str.size());
+        os.write((const char*)&len, sizeof(len));
+        os.write(str.data(), len);
+    };
+
+    for (const auto & item : textureList) {
+        writeString(item.first);
+        writeString(item.second);
+    }
+
+    return bool(os);
+}
@@ -0,0 +1,77 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __MAPGENERATOR_H__
+#define __MAPGENERATOR_H__
+
+#include "../WorldMap.h"
+
+#include <stdint.h>
+#include <ostream>
+#include <vector>
+
+
+/* -------------------------------------------------------------------------- */
+
+// Procedural world map generator.
+// Each cell is a pure function of (seed, row, col), so that maps of any size
+// can be streamed to disk row by row without keeping them in memory.
+//
+// Cell layout (same as res/world.ini):
+//   bits  0..7  wall texture (0 = empty cell)
+//   bits  8..15 ceiling texture (0xff = sky)
+//   bits 16..23 floor texture
+//   bits 24..31 transparent panel texture
+//   bits 32..39 upper wall (height) texture
+class MapGenerator
+{
+public:
+    using Cell = WorldMap::Cell;
+
+    struct Params {
+        uint32_t rows = 64;
+        uint32_t cols = 64;
+        double wallDensity = 0.15;      // walls per non-open cell
+        double transpRatio = 0.02;      // transparent panels per empty cell
+        double openAreaRatio = 0.25;    // 8x8 blocks kept free of walls
+        double wallHeightRatio = 0.5;   // walls having an upper texture
+        double skyRatio = 0.5;          // empty cells showing the sky
+        int textureCount = 14;          // texture keys 01..textureCount
+        uint32_t seed = 1;
+    };
+
+    MapGenerator(const Params& params) noexcept;
+
+    const Params& getParams() const noexcept {
+        return m_params;
+    }
+
+    Cell cellAt(uint32_t row, uint32_t col) const noexcept;
+
+    void generate(std::vector<Cell>& cells) const;
+
+    bool writeText(std::ostream& os) const;
+    bool writeBinary(std::ostream& os) const;
+
+    WorldMap::TextureList getTextureList() const;
+
+private:
+    double random(uint32_t row, uint32_t col, uint32_t salt) const noexcept;
+    Cell texture(uint32_t row, uint32_t col, uint32_t salt) const noexcept;
+
+    bool isSpawnArea(uint32_t row, uint32_t col) const noexcept;
+
+    Params m_params;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif // __MAPGENERATOR_H__
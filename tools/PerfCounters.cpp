@@ -0,0 +1,162 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "PerfCounters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#endif
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifdef __linux__
+
+namespace {
+
+struct EventType {
+    const char* name;
+    uint32_t type;
+    uint64_t config;
+};
+
+const EventType EVENT_TYPES[] = {
+    { "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { "l1d_misses", PERF_TYPE_HW_CACHE,
+        PERF_COUNT_HW_CACHE_L1D |
+        (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    { "llc_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    { "branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+};
+
+} // namespace
+
+#endif
+
+
+/* -------------------------------------------------------------------------- */
+
+PerfCounters::PerfCounters()
+{
+#ifdef __linux__
+    // The events are a group, scheduled on the CPU all together, so that
+    // their counts refer to the same time; the first one is the leader
+    int leader = -1;
+
+    for (const auto & type : EVENT_TYPES) {
+        if (m_events.size() >= FrameProfiler::MAX_EVENTS) {
+            break;
+        }
+
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+
+        attr.size = sizeof(attr);
+        attr.type = type.type;
+        attr.config = type.config;
+        attr.disabled = leader < 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP |
+            PERF_FORMAT_TOTAL_TIME_ENABLED |
+            PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        const int fd = int(syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+
+        if (fd < 0) {
+            if (m_lastError.empty()) {
+                m_lastError = std::string(type.name) + ": " + strerror(errno);
+            }
+
+            continue;
+        }
+
+        if (leader < 0) {
+            leader = fd;
+        }
+
+        m_events.push_back(Event{ type.name, fd });
+    }
+
+    if (leader >= 0) {
+        ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    // Count, time enabled, time running, and a value per event
+    m_buffer.resize(3 + m_events.size());
+#else
+    m_lastError = "not supported on this system";
+#endif
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+PerfCounters::~PerfCounters()
+{
+#ifdef __linux__
+    // The leader last
+    for (auto event = m_events.rbegin(); event != m_events.rend(); ++event) {
+        close(event->fd);
+    }
+#endif
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+bool PerfCounters::read(uint64_t* counts) noexcept
+{
+#ifdef __linux__
+    if (m_events.empty()) {
+        return false;
+    }
+
+    const ssize_t size = ssize_t(m_buffer.size() * sizeof(uint64_t));
+
+    // The counts are left as they are, rather than set to values which
+    // the next reading would be compared with
+    if (::read(m_events.front().fd, m_buffer.data(), size) != size ||
+        m_buffer[0] != m_events.size())
+    {
+        return false;
+    }
+
+    const uint64_t enabled = m_buffer[1];
+    const uint64_t running = m_buffer[2];
+
+    for (size_t event = 0; event < m_events.size(); ++event) {
+        uint64_t count = m_buffer[3 + event];
+
+        // The group was counting for part of the time only
+        if (running && running < enabled) {
+            count = uint64_t(double(count) * double(enabled) / double(running));
+        }
+
+        counts[event] = running ? count : 0;
+    }
+
+    return true;
+#else
+    (void)counts;
+    return false;
+#endif
+}
+
+
+/* -------------------------------------------------------------------------- */
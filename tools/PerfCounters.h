@@ -0,0 +1,73 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __PERFCOUNTERS_H__
+#define __PERFCOUNTERS_H__
+
+#include "../FrameProfiler.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+
+/* -------------------------------------------------------------------------- */
+
+// Hardware event counters of the calling thread, in user space, read by
+// means of the Linux perf_event_open system call: cycles, instructions,
+// L1 data cache read misses, last level cache misses and branch misses.
+// Events the kernel or the CPU cannot count (e.g. in a virtual machine),
+// or that kernel.perf_event_paranoid forbids, are left out, and no event
+// at all is available on other systems (see isAvailable). The counts are
+// scaled when the kernel multiplexes the counters.
+class PerfCounters : public FrameProfiler::Meter
+{
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // Return true if any event can be counted
+    bool isAvailable() const noexcept {
+        return !m_events.empty();
+    }
+
+    // Return the reason why the events left out are not available
+    const std::string& getLastError() const noexcept {
+        return m_lastError;
+    }
+
+    int getEventCount() const noexcept override {
+        return int(m_events.size());
+    }
+
+    const char* getEventName(int event) const noexcept override {
+        return event >= 0 && event < getEventCount() ? m_events[event].name : "";
+    }
+
+    bool read(uint64_t* counts) noexcept override;
+
+private:
+    struct Event {
+        const char* name;
+        int fd;
+    };
+
+    std::vector<Event> m_events;
+    std::vector<uint64_t> m_buffer;
+    std::string m_lastError;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif // __PERFCOUNTERS_H__
@@ -0,0 +1,58 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "SceneLoader.h"
+
+#include <stdlib.h>
+
+
+/* -------------------------------------------------------------------------- */
+
+bool SceneLoader::load(
+    const std::string& resDir,
+    const std::string& mapFile,
+    int cellSize,
+    int skyDx,
+    int skyDy)
+{
+    if (m_pack.open(resDir + "/world.pak")) {
+        if (!m_pack.loadMap(m_world)) {
+            m_lastError = resDir + "/world.pak: " + m_world.getLastError();
+            return false;
+        }
+
+        m_pack.applyTo(m_world);
+    }
+    else {
+        if (!m_world.load(resDir + "/" + mapFile)) {
+            m_lastError = resDir + "/" + mapFile + ": " + m_world.getLastError();
+            return false;
+        }
+
+        for (const auto & item : m_world.getTextureList()) {
+            m_loader.add(
+                int(strtol(item.first.c_str(), nullptr, 16)),
+                resDir + "/" + item.second + ".bmp",
+                cellSize, cellSize);
+        }
+
+        m_loader.add(0xff, resDir + "/clouds.bmp", skyDx, skyDy);
+        m_loader.start();
+        m_loader.wait();
+        m_loader.applyTo(m_world);
+    }
+
+    m_world.resizeCell(cellSize, cellSize);
+
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
@@ -0,0 +1,69 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+#ifndef __SCENELOADER_H__
+#define __SCENELOADER_H__
+
+#include "../AssetPack.h"
+#include "../TextureLoader.h"
+#include "../WorldMap.h"
+
+#include <string>
+#include <vector>
+
+
+/* -------------------------------------------------------------------------- */
+
+// Loads the map and the textures of a resource directory the way the
+// application does: from DIR/world.pak when present, otherwise from the
+// map file and the BMP files. The textures (memory-mapped from the pack,
+// or decoded by the loader) live as long as the loader does.
+class SceneLoader
+{
+public:
+    // Load the scene with cells (and wall textures) of cellSize pixels and
+    // a sky of skyDx x skyDy pixels (a pack keeps its own sizes)
+    // @return false if the map cannot be loaded (see getLastError); a
+    // texture missing is not an error (see getFailedFiles)
+    bool load(
+        const std::string& resDir,
+        const std::string& mapFile,
+        int cellSize,
+        int skyDx,
+        int skyDy);
+
+    WorldMap& world() noexcept {
+        return m_world;
+    }
+
+    bool isPacked() const noexcept {
+        return m_pack.isOpen();
+    }
+
+    const std::string& getLastError() const noexcept {
+        return m_lastError;
+    }
+
+    // Return the texture files which could not be loaded
+    std::vector<std::string> getFailedFiles() const {
+        return m_loader.getFailedFiles();
+    }
+
+private:
+    WorldMap m_world;
+    AssetPack m_pack;
+    TextureLoader m_loader;
+    std::string m_lastError;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+#endif // __SCENELOADER_H__
@@ -0,0 +1,423 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+// framebench: renders the frames of a scripted camera path without a
+// display, through the same engine as the application, and reports the
+// frame times (mean, median, 99th percentile), the frame rate and the
+// time of each stage of the frames. The camera poses depend on the frame
+// number only, so that runs on different machines render the same frames.
+//
+// Usage: framebench [options]
+//   --res DIR        resource directory (default: res); DIR/world.pak is
+//                    used when present
+//   --map FILE       map file, relative to DIR (default: world.ini)
+//   --size WxH       projection resolution (default: 512x512)
+//   --cell N         cell and wall texture size (default: 512)
+//   --path FILE      camera path script (see CameraPath.h; default: a
+//                    built-in path of res/world.ini)
+//   --frames N       frames measured (default: the frames of the path,
+//                    which is repeated if shorter)
+//   --warmup N       frames rendered before the measured ones (default: 30)
+//   --no-stages      do not time the stages of the frames (which costs a
+//                    few clock readings per ray)
+//   --csv FILE       write the timings of each measured frame to a CSV
+//                    file
+//   --perf           count hardware events (cycles, instructions, cache and
+//                    branch misses) in each frame, by means of Linux
+//                    perf_event_open; left out if not available
+//   --perf-stages    count them in each stage of the frames too (which
+//                    costs a system call per stage and per ray)
+//   --trace FILE     write a Chrome trace of the loading and of the frames
+//                    to FILE, to be opened with Perfetto
+//
+// The work counters of the frames (see RenderCounters.h) are reported too
+// when compiled in (make COUNTERS=1).
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "CameraPath.h"
+#include "PerfCounters.h"
+#include "SceneLoader.h"
+#include "../FrameProfiler.h"
+#include "../FrameSink.h"
+#include "../RaycastEngine.h"
+#include "../TraceLog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <math.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/* -------------------------------------------------------------------------- */
+
+using Clock = std::chrono::steady_clock;
+
+// Discards the frames: only rendering is measured
+class NullFrameSink : public FrameSink
+{
+public:
+    bool present(const Frame&) override {
+        return true;
+    }
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+// Return the q-quantile (nearest rank) of sorted values
+static double quantile(const std::vector<double>& sorted, double q)
+{
+    if (sorted.empty()) {
+        return 0.0;
+    }
+
+    size_t rank = size_t(ceil(q * sorted.size()));
+
+    return sorted[rank ? std::min(rank, sorted.size()) - 1 : 0];
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+// Print the hardware events counted per frame (and per stage)
+static void reportEvents(
+    const FrameProfiler::Meter& meter,
+    const FrameProfiler::Sample& avg,
+    bool perStage)
+{
+    const int events = meter.getEventCount();
+    int cycles = -1;
+    int instructions = -1;
+    char line[128];
+
+    std::cout << "hardware events per frame (mean)" << std::endl;
+
+    for (int event = 0; event < events; ++event) {
+        const std::string name = meter.getEventName(event);
+
+        snprintf(line, sizeof(line), "%-16s %14llu",
+            name.c_str(), (unsigned long long)avg.events[event]);
+
+        std::cout << "  " << line << std::endl;
+
+        if (name == "cycles") {
+            cycles = event;
+        }
+        else if (name == "instructions") {
+            instructions = event;
+        }
+    }
+
+    if (cycles >= 0 && instructions >= 0 && avg.events[cycles]) {
+        snprintf(line, sizeof(line), "%-16s %14.2f", "ipc",
+            double(avg.events[instructions]) / double(avg.events[cycles]));
+
+        std::cout << "  " << line << std::endl;
+    }
+
+    if (!perStage) {
+        return;
+    }
+
+    std::cout << "hardware events per stage (mean)" << std::endl << "  "
+        << std::string(16, ' ');
+
+    for (int event = 0; event < events; ++event) {
+        snprintf(line, sizeof(line), " %14s", meter.getEventName(event));
+        std::cout << line;
+    }
+
+    std::cout << std::endl;
+
+    for (int stage = 0; stage < FrameProfiler::STAGE_COUNT; ++stage) {
+        snprintf(line, sizeof(line), "%-16s", FrameProfiler::getStageName(stage));
+        std::cout << "  " << line;
+
+        for (int event = 0; event < events; ++event) {
+            snprintf(line, sizeof(line), " %14llu",
+                (unsigned long long)avg.stageEvents[stage][event]);
+
+            std::cout << line;
+        }
+
+        std::cout << std::endl;
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+static void usage()
+{
+    std::cerr <<
+        "Usage: framebench [--res DIR] [--map FILE] [--size WxH] [--cell N]\n"
+        "                  [--path FILE] [--frames N] [--warmup N]\n"
+        "                  [--no-stages] [--csv FILE] [--perf]\n"
+        "                  [--perf-stages] [--trace FILE]\n";
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+int main(int argc, char* argv[])
+{
+    std::string resDir = "res";
+    std::string mapFile = "world.ini";
+    std::string pathFile;
+    std::string csvFile;
+    std::string traceFile;
+    int xRes = 512;
+    int yRes = 512;
+    int cellSize = 512;
+    int frames = -1;
+    int warmup = 30;
+    bool stages = true;
+    bool perf = false;
+    bool perfStages = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+
+        if (arg == "--no-stages") {
+            stages = false;
+            continue;
+        }
+
+        if (arg == "--perf" || arg == "--perf-stages") {
+            perf = true;
+            perfStages = perfStages || arg == "--perf-stages";
+            continue;
+        }
+
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+
+        const char* value = argv[++i];
+        bool ok = true;
+
+        if (arg == "--res") {
+            resDir = value;
+        }
+        else if (arg == "--map") {
+            mapFile = value;
+        }
+        else if (arg == "--size") {
+            ok = sscanf(value, "%dx%d", &xRes, &yRes) == 2;
+        }
+        else if (arg == "--cell") {
+            cellSize = atoi(value);
+        }
+        else if (arg == "--path") {
+            pathFile = value;
+        }
+        else if (arg == "--frames") {
+            frames = atoi(value);
+            ok = frames > 0;
+        }
+        else if (arg == "--warmup") {
+            warmup = atoi(value);
+            ok = warmup >= 0;
+        }
+        else if (arg == "--csv") {
+            csvFile = value;
+        }
+        else if (arg == "--trace") {
+            traceFile = value;
+        }
+        else {
+            ok = false;
+        }
+
+        if (!ok) {
+            usage();
+            return 1;
+        }
+    }
+
+    if (xRes < 8 || yRes < 8 || cellSize < 1 ||
+        (!stages && (!csvFile.empty() || perf)))
+    {
+        usage();
+        return 1;
+    }
+
+    CameraPath path;
+
+    if (pathFile.empty()) {
+        path.setDefault();
+    }
+    else if (!path.load(pathFile)) {
+        std::cerr << "framebench: " << path.getLastError() << std::endl;
+        return 1;
+    }
+
+    if (frames < 0) {
+        frames = path.getFrameCount();
+    }
+
+    // Loading is traced as well
+    if (!traceFile.empty()) {
+        TraceLog::shared().setThreadName("framebench");
+        TraceLog::shared().setEnabled(true);
+    }
+
+    SceneLoader scene;
+
+    if (!scene.load(resDir, mapFile, cellSize, xRes, yRes)) {
+        std::cerr << "framebench: " << scene.getLastError() << std::endl;
+        return 1;
+    }
+
+    for (const auto & file : scene.getFailedFiles()) {
+        std::cerr << "framebench: cannot load " << file << std::endl;
+    }
+
+    WorldMap& world = scene.world();
+
+    Player camera(0, 0, 60, xRes, yRes);
+    RaycastEngine engine(camera, 250000);
+    FrameProfiler profiler(frames);
+    NullFrameSink sink;
+
+    // The warm-up frames are the last ones of the (repeated) path, which
+    // lead to the first measured one
+    for (int frame = -warmup; frame < 0; ++frame) {
+        path.applyTo(frame, engine.player(), world);
+        engine.renderScene(world, sink);
+    }
+
+    // Hardware events are counted for this thread, the one rendering
+    std::unique_ptr<PerfCounters> perfCounters;
+
+    if (perf) {
+        perfCounters.reset(new PerfCounters);
+
+        if (!perfCounters->isAvailable()) {
+            std::cerr << "framebench: hardware events not available ("
+                << perfCounters->getLastError() << ")" << std::endl;
+        }
+        else if (!perfCounters->getLastError().empty()) {
+            std::cerr << "framebench: some hardware events not available ("
+                << perfCounters->getLastError() << ")" << std::endl;
+        }
+
+        profiler.setMeter(perfCounters.get(), perfStages);
+    }
+
+    if (stages) {
+        profiler.setEnabled(true);
+        engine.setProfiler(&profiler);
+    }
+
+    std::vector<double> times(frames);
+    const auto begin = Clock::now();
+
+    for (int frame = 0; frame < frames; ++frame) {
+        path.applyTo(frame, engine.player(), world);
+
+        const auto frameBegin = Clock::now();
+
+        engine.renderScene(world, sink);
+
+        times[frame] = std::chrono::duration<double, std::milli>(
+            Clock::now() - frameBegin).count();
+    }
+
+    const double ms = std::chrono::duration<double, std::milli>(
+        Clock::now() - begin).count();
+
+    TraceLog::shared().setEnabled(false);
+
+    double mean = 0.0;
+
+    for (double time : times) {
+        mean += time;
+    }
+
+    mean /= frames;
+
+    std::vector<double> sorted = times;
+    std::sort(sorted.begin(), sorted.end());
+
+    char line[128];
+
+    std::cout << "framebench: " << xRes << "x" << yRes << ", " << frames
+        << " frames of " << (pathFile.empty() ? "the built-in path" : pathFile)
+        << " (" << path.getFrameCount() << " frames), " << warmup
+        << " warm-up frames" << std::endl;
+
+    snprintf(line, sizeof(line),
+        "frame time   mean %.3f ms, p50 %.3f ms, p99 %.3f ms, "
+        "min %.3f ms, max %.3f ms",
+        mean, quantile(sorted, 0.5), quantile(sorted, 0.99),
+        sorted.front(), sorted.back());
+
+    std::cout << line << std::endl;
+
+    snprintf(line, sizeof(line), "frame rate   %.1f fps", frames * 1000.0 / ms);
+    std::cout << line << std::endl;
+
+    if (stages) {
+        const FrameProfiler::Sample avg = profiler.getAverage(size_t(frames));
+
+        for (int stage = 0; stage < FrameProfiler::STAGE_COUNT; ++stage) {
+            snprintf(line, sizeof(line), "%-16s %7.3f ms (%4.1f%%)",
+                FrameProfiler::getStageName(stage), avg.stages[stage],
+                avg.total > 0 ? 100.0 * avg.stages[stage] / avg.total : 0.0);
+
+            std::cout << "  " << line << std::endl;
+        }
+
+        // Work done per frame, if the counters are compiled in
+        if (RenderCounters::ENABLED) {
+            std::cout << "work per frame (mean)" << std::endl;
+
+            for (int counter = 0; counter < RenderCounters::COUNTER_COUNT; ++counter) {
+                snprintf(line, sizeof(line), "%-22s %10llu",
+                    RenderCounters::getName(counter),
+                    (unsigned long long)avg.counters.get(counter));
+
+                std::cout << "  " << line << std::endl;
+            }
+        }
+
+        if (const FrameProfiler::Meter* meter = profiler.getMeter()) {
+            reportEvents(*meter, avg, profiler.isMeteringStages());
+        }
+    }
+
+    if (!csvFile.empty() && !profiler.writeCsv(csvFile)) {
+        std::cerr << "framebench: cannot write " << csvFile << std::endl;
+        return 1;
+    }
+
+    if (!traceFile.empty()) {
+        if (!TraceLog::shared().write(traceFile)) {
+            std::cerr << "framebench: cannot write " << traceFile << std::endl;
+            return 1;
+        }
+
+        if (const size_t dropped = TraceLog::shared().getDroppedCount()) {
+            std::cerr << "framebench: " << dropped << " trace events dropped"
+                << std::endl;
+        }
+    }
+
+    return 0;
+}
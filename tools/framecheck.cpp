@@ -0,0 +1,495 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+// framecheck: renders the frames of a set of camera poses without a
+// display and compares them with golden ones, so that changes of the
+// engine which alter its output are detected.
+//
+// --record DIR writes the hash of each frame to DIR/hashes.txt and the
+// frame itself to DIR/<frame>.bmp. --check DIR renders the frames listed
+// in DIR/hashes.txt again: a frame whose hash matches is identical; any
+// other one is compared pixel by pixel with DIR/<frame>.bmp, when
+// present, and accepted if its pixels are within a tolerance (e.g. for
+// an approved approximation). A tolerance check needs the images of all
+// the frames and fails at once without them: tools/golden holds the
+// hashes only, so record a reference with a known good build first.
+// The exit status is 0 only if every frame is accepted.
+//
+// Usage: framecheck [options] --record DIR | --check DIR
+//   --res DIR        resource directory (default: res); DIR/world.pak is
+//                    used when present
+//   --map FILE       map file, relative to DIR (default: world.ini)
+//   --size WxH       projection resolution (default: 512x512)
+//   --cell N         cell and wall texture size (default: 512)
+//   --path FILE      camera path script (see CameraPath.h; default: a
+//                    built-in path of res/world.ini)
+//   --step N         record one frame of the path every N (default: 20)
+//   --tolerance T    largest difference of a channel of a pixel accepted
+//                    (default: 0)
+//   --max-pixels P   percentage of the pixels of a frame allowed to
+//                    exceed the tolerance (default: 0)
+//   --save DIR       write the frames which are not identical, and an
+//                    image of their differences, to DIR
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "CameraPath.h"
+#include "SceneLoader.h"
+#include "../FrameSink.h"
+#include "../RaycastEngine.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/* -------------------------------------------------------------------------- */
+
+#define HASH_FILE "hashes.txt"
+
+
+/* -------------------------------------------------------------------------- */
+
+// Golden frame: a frame of the path and the hash of its pixels
+struct Golden {
+    int frame;
+    int width;
+    int height;
+    uint64_t hash;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+// FNV-1a hash of the color channels of the pixels (the unused byte of
+// each one is ignored)
+static uint64_t hashFrame(const Frame& frame)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (int y = 0; y < frame.height; ++y) {
+        for (int x = 0; x < frame.width; ++x) {
+            const DWORD pixel = frame.getPixel(x, y);
+
+            for (int shift = 0; shift < 24; shift += 8) {
+                hash ^= (pixel >> shift) & 0xff;
+                hash *= 0x100000001b3ULL;
+            }
+        }
+    }
+
+    return hash;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+static std::string frameFileName(const std::string& dir, int frame)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "/%04d.bmp", frame);
+
+    return dir + name;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+static bool writeBmp(const std::string& fileName, const Frame& frame)
+{
+    FILE* file = fopen(fileName.c_str(), "wb");
+
+    if (!file) {
+        return false;
+    }
+
+    const bool ok = FileFrameSink::writeBmp(file, frame);
+
+    return fclose(file) == 0 && ok;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+// Read a BMP file as written by FileFrameSink::writeBmp (32 bit, top-down)
+static bool readBmp(
+    const std::string& fileName,
+    std::vector<DWORD>& pixels,
+    int& width,
+    int& height)
+{
+    std::ifstream is(fileName, std::ios::binary);
+    uint8_t hdr[14 + 40];
+
+    if (!is.read((char*)hdr, sizeof(hdr))) {
+        return false;
+    }
+
+    auto get32 = [&hdr](size_t offset) {
+        return uint32_t(hdr[offset]) | uint32_t(hdr[offset + 1]) << 8 |
+            uint32_t(hdr[offset + 2]) << 16 | uint32_t(hdr[offset + 3]) << 24;
+    };
+
+    width = int(get32(18));
+    height = -int(get32(22));
+
+    if (hdr[0] != 'B' || hdr[1] != 'M' || hdr[28] != 32 ||
+        width <= 0 || height <= 0 || width > 16384 || height > 16384)
+    {
+        return false;
+    }
+
+    pixels.resize(size_t(width) * size_t(height));
+
+    return bool(is.seekg(get32(10)).read(
+        (char*)pixels.data(), std::streamsize(pixels.size() * sizeof(DWORD))));
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+static bool readHashes(const std::string& fileName, std::vector<Golden>& golden)
+{
+    std::ifstream is(fileName);
+    std::string line;
+
+    if (!is.is_open()) {
+        return false;
+    }
+
+    while (std::getline(is, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::istringstream ls(line);
+        Golden item;
+
+        if (!(ls >> item.frame >> item.width >> item.height >> std::hex >> item.hash)) {
+            return false;
+        }
+
+        golden.push_back(item);
+    }
+
+    return !golden.empty();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+static void usage()
+{
+    std::cerr <<
+        "Usage: framecheck [--res DIR] [--map FILE] [--size WxH] [--cell N]\n"
+        "                  [--path FILE] [--step N] [--tolerance T]\n"
+        "                  [--max-pixels P] [--save DIR]\n"
+        "                  --record DIR | --check DIR\n";
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+int main(int argc, char* argv[])
+{
+    std::string resDir = "res";
+    std::string mapFile = "world.ini";
+    std::string pathFile;
+    std::string recordDir;
+    std::string checkDir;
+    std::string saveDir;
+    int xRes = 512;
+    int yRes = 512;
+    int cellSize = 512;
+    int step = 20;
+    int tolerance = 0;
+    double maxPixels = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+
+        const char* value = argv[++i];
+        bool ok = true;
+
+        if (arg == "--res") {
+            resDir = value;
+        }
+        else if (arg == "--map") {
+            mapFile = value;
+        }
+        else if (arg == "--size") {
+            ok = sscanf(value, "%dx%d", &xRes, &yRes) == 2;
+        }
+        else if (arg == "--cell") {
+            cellSize = atoi(value);
+        }
+        else if (arg == "--path") {
+            pathFile = value;
+        }
+        else if (arg == "--step") {
+            step = atoi(value);
+            ok = step > 0;
+        }
+        else if (arg == "--tolerance") {
+            tolerance = atoi(value);
+            ok = tolerance >= 0 && tolerance <= 255;
+        }
+        else if (arg == "--max-pixels") {
+            maxPixels = atof(value);
+            ok = maxPixels >= 0 && maxPixels <= 100;
+        }
+        else if (arg == "--save") {
+            saveDir = value;
+        }
+        else if (arg == "--record") {
+            recordDir = value;
+        }
+        else if (arg == "--check") {
+            checkDir = value;
+        }
+        else {
+            ok = false;
+        }
+
+        if (!ok) {
+            usage();
+            return 1;
+        }
+    }
+
+    if (recordDir.empty() == checkDir.empty() ||
+        xRes < 8 || yRes < 8 || cellSize < 1)
+    {
+        usage();
+        return 1;
+    }
+
+    CameraPath path;
+
+    if (pathFile.empty()) {
+        path.setDefault();
+    }
+    else if (!path.load(pathFile)) {
+        std::cerr << "framecheck: " << path.getLastError() << std::endl;
+        return 1;
+    }
+
+    // The frames to check are the recorded ones
+    std::vector<Golden> golden;
+
+    if (!checkDir.empty()) {
+        if (!readHashes(checkDir + "/" HASH_FILE, golden)) {
+            std::cerr << "framecheck: cannot read " << checkDir << "/" HASH_FILE
+                << std::endl;
+            return 1;
+        }
+
+        // A tolerance check is meaningless without the images: it is
+        // refused at once, rather than failing frame by frame as hash
+        // mismatches (or passing the identical frames only)
+        for (const Golden & item : golden) {
+            const std::string fileName = frameFileName(checkDir, item.frame);
+
+            if ((tolerance > 0 || maxPixels > 0) &&
+                !std::ifstream(fileName, std::ios::binary).is_open())
+            {
+                std::cerr << "framecheck: a tolerance check needs the reference "
+                    "image " << fileName << ", which is missing (record the "
+                    "reference with --record from a known good build)"
+                    << std::endl;
+                return 1;
+            }
+        }
+    }
+    else {
+        for (int frame = 0; frame < path.getFrameCount(); frame += step) {
+            golden.push_back(Golden{ frame, xRes, yRes, 0 });
+        }
+    }
+
+    SceneLoader scene;
+
+    if (!scene.load(resDir, mapFile, cellSize, xRes, yRes)) {
+        std::cerr << "framecheck: " << scene.getLastError() << std::endl;
+        return 1;
+    }
+
+    for (const auto & file : scene.getFailedFiles()) {
+        std::cerr << "framecheck: cannot load " << file << std::endl;
+    }
+
+    WorldMap& world = scene.world();
+
+    Player camera(0, 0, 60, xRes, yRes);
+    RaycastEngine engine(camera, 250000);
+    MemoryFrameSink sink;
+
+    std::ofstream hashes;
+
+    if (!recordDir.empty()) {
+        hashes.open(recordDir + "/" HASH_FILE);
+
+        if (!hashes.is_open()) {
+            std::cerr << "framecheck: cannot write " << recordDir << "/" HASH_FILE
+                << std::endl;
+            return 1;
+        }
+
+        hashes << "# framecheck golden frames of "
+            << (pathFile.empty() ? "the built-in path" : pathFile)
+            << ", cell size " << cellSize << "\n"
+            << "# frame width height hash\n";
+    }
+
+    int identical = 0;
+    int similar = 0;
+    int failed = 0;
+
+    for (const Golden & item : golden) {
+        if (item.width != xRes || item.height != yRes) {
+            std::cerr << "framecheck: frame " << item.frame << " was recorded at "
+                << item.width << "x" << item.height << " (see --size)" << std::endl;
+            return 1;
+        }
+
+        path.applyTo(item.frame, engine.player(), world);
+        engine.renderScene(world, sink);
+
+        const Frame frame = sink.getFrame();
+        const uint64_t hash = hashFrame(frame);
+
+        char line[128];
+
+        if (!recordDir.empty()) {
+            snprintf(line, sizeof(line), "%d %d %d %016llx\n",
+                item.frame, frame.width, frame.height, (unsigned long long)hash);
+
+            hashes << line;
+
+            if (!writeBmp(frameFileName(recordDir, item.frame), frame)) {
+                std::cerr << "framecheck: cannot write "
+                    << frameFileName(recordDir, item.frame) << std::endl;
+                return 1;
+            }
+
+            continue;
+        }
+
+        if (hash == item.hash) {
+            ++identical;
+            continue;
+        }
+
+        // Compare the pixels with the golden frame, if it was kept
+        std::vector<DWORD> pixels;
+        int width = 0;
+        int height = 0;
+
+        if (!readBmp(frameFileName(checkDir, item.frame), pixels, width, height) ||
+            width != frame.width || height != frame.height)
+        {
+            snprintf(line, sizeof(line), "frame %4d: hash %016llx, expected %016llx",
+                item.frame, (unsigned long long)hash, (unsigned long long)item.hash);
+
+            std::cout << line << std::endl;
+            ++failed;
+            continue;
+        }
+
+        // Differences, as a picture (differing channels amplified)
+        std::vector<DWORD> diff(pixels.size());
+        size_t outliers = 0;
+        int maxDelta = 0;
+
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                const size_t i = size_t(y) * size_t(width) + size_t(x);
+                const DWORD a = frame.getPixel(x, y);
+                const DWORD b = pixels[i];
+                int pixelDelta = 0;
+
+                for (int shift = 0; shift < 24; shift += 8) {
+                    const int delta = abs(int((a >> shift) & 0xff) - int((b >> shift) & 0xff));
+
+                    if (delta > pixelDelta) {
+                        pixelDelta = delta;
+                    }
+
+                    diff[i] |= DWORD(delta * 8 > 255 ? 255 : delta * 8) << shift;
+                }
+
+                if (pixelDelta > maxDelta) {
+                    maxDelta = pixelDelta;
+                }
+
+                if (pixelDelta > tolerance) {
+                    ++outliers;
+                }
+            }
+        }
+
+        const double percent = 100.0 * double(outliers) / double(pixels.size());
+        const bool ok = percent <= maxPixels;
+
+        snprintf(line, sizeof(line),
+            "frame %4d: max difference %d, %.3f%% of the pixels over %d, %s",
+            item.frame, maxDelta, percent, tolerance, ok ? "accepted" : "FAILED");
+
+        std::cout << line << std::endl;
+
+        if (ok) {
+            ++similar;
+        }
+        else {
+            ++failed;
+        }
+
+        if (!saveDir.empty()) {
+            char suffix[32];
+            snprintf(suffix, sizeof(suffix), "/%04d-diff.bmp", item.frame);
+
+            if (!writeBmp(frameFileName(saveDir, item.frame), frame) ||
+                !writeBmp(saveDir + suffix, Frame{ diff.data(), width, height, width }))
+            {
+                std::cerr << "framecheck: cannot write to " << saveDir << std::endl;
+            }
+        }
+    }
+
+    if (!recordDir.empty()) {
+        if (!hashes.flush()) {
+            std::cerr << "framecheck: error writing " << recordDir << "/" HASH_FILE
+                << std::endl;
+            return 1;
+        }
+
+        std::cout << "framecheck: " << golden.size() << " frames recorded to "
+            << recordDir << std::endl;
+
+        return 0;
+    }
+
+    std::cout << "framecheck: " << golden.size() << " frames, " << identical
+        << " identical, " << similar << " within tolerance, " << failed
+        << " failed" << std::endl;
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,387 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+// mapbench: generates maps of increasing size and wall density, loads them
+// through WorldMap::load and measures the ray traversal cost of a frame
+// (one ray per projection column, walked across the grid the same way the
+// engine does before texturing).
+//
+// Usage: mapbench [options]
+//   --sizes L        comma separated map sizes (default 64,256,1024,4096)
+//   --walls L        comma separated wall densities (default 0.05,0.15,0.3)
+//   --transp R       transparent panel ratio
+//   --open R         open area ratio
+//   --heights R      ratio of walls with an upper texture
+//   --frames N       frames to cast per configuration (default 200)
+//   --format F       map file format: 'bin' (default) or 'text'
+//   --dir D          directory of the generated maps (default /tmp)
+//   --csv F          also write the results to a CSV file
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "MapGenerator.h"
+#include "../WorldMap.h"
+#include "../Player.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/* -------------------------------------------------------------------------- */
+
+#define CELL_SIZE     512
+#define VISUAL_DEGREE 60
+#define PROJ_X_RES    512
+#define PROJ_Y_RES    512
+
+
+/* -------------------------------------------------------------------------- */
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsedMs(Clock::time_point since)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+template <class T>
+static std::vector<T> parseList(const std::string& list)
+{
+    std::vector<T> values;
+    std::stringstream ss(list);
+    std::string item;
+
+    while (std::getline(ss, item, ',')) {
+        std::stringstream is(item);
+        T value;
+
+        if (is >> value) {
+            values.push_back(value);
+        }
+    }
+
+    return values;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+// Walk the vertical and the horizontal grid intersections of a ray until
+// a wall is hit or the ray leaves the map; return the number of visited cells
+static int castRay(const WorldMap& wMap, const Player& player, int ray)
+{
+    const double xp = player.getX();
+    const double yp = player.getY();
+    const double maxX = wMap.getMaxX();
+    const double maxY = wMap.getMaxY();
+    const int cellDx = wMap.getCellDx();
+    const int cellDy = wMap.getCellDy();
+    const int rows = wMap.getRowCount();
+    const int cols = wMap.getColCount();
+
+    const double M = player.tan(ray);
+    const double M1 = player.invtan(ray);
+
+    const bool left = ray >= player.deg90() && ray < player.deg270();
+    const bool up = ray >= player.deg180() && ray < player.deg360();
+
+    auto wallAt = [&](double x, double y, int dc, int dr) {
+        int c = int(x / cellDx) + dc;
+        int r = int(y / cellDy) + dr;
+
+        c = c < 0 ? 0 : (c >= cols ? cols - 1 : c);
+        r = r < 0 ? 0 : (r >= rows ? rows - 1 : r);
+
+        return (wMap[r][c] & 0xff) != 0;
+    };
+
+    auto inside = [&](double x, double y) {
+        return x >= 0 && x <= maxX && y >= 0 && y <= maxY;
+    };
+
+    int visited = 0;
+
+    // vertical intersections
+    double xi = double(player.getCol(cellDx) + (left ? 0 : 1)) * cellDx;
+    double yi = M * (xi - xp) + yp;
+
+    while (++visited, !wallAt(xi, yi, left ? -1 : 0, 0)) {
+        xi += left ? -cellDx : cellDx;
+        yi += left ? -M * cellDx : M * cellDx;
+
+        if (!inside(xi, yi)) {
+            break;
+        }
+    }
+
+    // horizontal intersections
+    yi = double(player.getRow(cellDy) + (up ? 0 : 1)) * cellDy;
+    xi = M1 * (yi - yp) + xp;
+
+    while (++visited, !wallAt(xi, yi, 0, up ? -1 : 0)) {
+        xi += up ? -M1 * cellDy : M1 * cellDy;
+        yi += up ? -cellDy : cellDy;
+
+        if (!inside(xi, yi)) {
+            break;
+        }
+    }
+
+    return visited;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+struct BenchResult {
+    uint32_t size = 0;
+    double walls = 0;
+    double fileMb = 0;
+    double loadMs = 0;
+    double frameMs = 0;
+    double raysPerSec = 0;
+    double cellsPerRay = 0;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+static bool runBench(
+    const MapGenerator::Params& params,
+    const std::string& fileName,
+    bool binary,
+    int frames,
+    BenchResult& res)
+{
+    {
+        std::ofstream os(fileName, std::ios::out | std::ios::binary);
+        MapGenerator generator(params);
+
+        if (!os.is_open() ||
+            !(binary ? generator.writeBinary(os) : generator.writeText(os)))
+        {
+            return false;
+        }
+
+        res.fileMb = double(os.tellp()) / (1024.0 * 1024.0);
+    }
+
+    WorldMap wMap;
+
+    auto t0 = Clock::now();
+    const bool loaded = wMap.load(fileName);
+    res.loadMs = elapsedMs(t0);
+
+    remove(fileName.c_str());
+
+    if (!loaded) {
+        std::cerr << fileName << ": " << wMap.getLastError() << std::endl;
+        return false;
+    }
+
+    wMap.resizeCell(CELL_SIZE, CELL_SIZE);
+
+    // Camera positions: centers of random empty cells
+    std::mt19937 rnd(params.seed);
+    std::vector<std::pair<int, int>> positions;
+
+    for (int i = 0; i < 10000 && positions.size() < 64; ++i) {
+        const int r = int(rnd() % wMap.getRowCount());
+        const int c = int(rnd() % wMap.getColCount());
+
+        if ((wMap[r][c] & 0xff) == 0) {
+            positions.push_back({ c * CELL_SIZE + CELL_SIZE / 2,
+                                  r * CELL_SIZE + CELL_SIZE / 2 });
+        }
+    }
+
+    if (positions.empty()) {
+        return false;
+    }
+
+    Player player(0, 0, VISUAL_DEGREE, PROJ_X_RES, PROJ_Y_RES);
+
+    uint64_t rays = 0;
+    uint64_t cells = 0;
+
+    t0 = Clock::now();
+
+    for (int frame = 0; frame < frames; ++frame) {
+        const auto & pos = positions[frame % positions.size()];
+
+        player.setPos({ double(pos.first), double(pos.second) });
+        player.setAlpha(frame * 37);
+
+        const int cameraRayOffset = player.getAlpha();
+
+        for (int ray = 0; ray < player.getXProjRes(); ++ray) {
+            int relRay = ray + cameraRayOffset;
+
+            if (relRay >= player.deg360()) {
+                relRay -= player.deg360();
+            }
+
+            cells += castRay(wMap, player, relRay);
+            ++rays;
+        }
+    }
+
+    const double totalMs = elapsedMs(t0);
+
+    res.size = params.rows;
+    res.walls = params.wallDensity;
+    res.frameMs = totalMs / frames;
+    res.raysPerSec = totalMs > 0 ? double(rays) * 1000.0 / totalMs : 0;
+    res.cellsPerRay = rays ? double(cells) / double(rays) : 0;
+
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+static void usage()
+{
+    std::cerr <<
+        "Usage: mapbench [--sizes L] [--walls L] [--transp R] [--open R]\n"
+        "                [--heights R] [--frames N] [--format bin|text]\n"
+        "                [--dir D] [--csv F]\n";
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+int main(int argc, char* argv[])
+{
+    std::vector<uint32_t> sizes{ 64, 256, 1024, 4096 };
+    std::vector<double> densities{ 0.05, 0.15, 0.30 };
+    MapGenerator::Params params;
+    std::string dir = "/tmp";
+    std::string csvFile;
+    bool binary = true;
+    int frames = 200;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+
+        const std::string value = argv[++i];
+        bool ok = true;
+
+        if (arg == "--sizes") {
+            sizes = parseList<uint32_t>(value);
+        }
+        else if (arg == "--walls") {
+            densities = parseList<double>(value);
+        }
+        else if (arg == "--transp") {
+            params.transpRatio = atof(value.c_str());
+        }
+        else if (arg == "--open") {
+            params.openAreaRatio = atof(value.c_str());
+        }
+        else if (arg == "--heights") {
+            params.wallHeightRatio = atof(value.c_str());
+        }
+        else if (arg == "--frames") {
+            frames = atoi(value.c_str());
+        }
+        else if (arg == "--format") {
+            binary = value == "bin";
+            ok = binary || value == "text";
+        }
+        else if (arg == "--dir") {
+            dir = value;
+        }
+        else if (arg == "--csv") {
+            csvFile = value;
+        }
+        else {
+            ok = false;
+        }
+
+        if (!ok) {
+            usage();
+            return 1;
+        }
+    }
+
+    if (frames < 1) {
+        frames = 1;
+    }
+
+    std::ofstream csv;
+
+    if (!csvFile.empty()) {
+        csv.open(csvFile);
+        csv << "size,walls,file_mb,load_ms,frame_ms,rays_per_sec,cells_per_ray\n";
+    }
+
+    std::cout << std::setw(8) << "size"
+              << std::setw(8) << "walls"
+              << std::setw(10) << "file(MB)"
+              << std::setw(12) << "load(ms)"
+              << std::setw(12) << "frame(ms)"
+              << std::setw(14) << "rays/s"
+              << std::setw(12) << "cells/ray"
+              << std::endl;
+
+    for (auto size : sizes) {
+        for (auto density : densities) {
+            params.rows = params.cols = size;
+            params.wallDensity = density;
+
+            const std::string fileName = dir + "/mapbench_" +
+                std::to_string(size) + (binary ? ".bin" : ".ini");
+
+            BenchResult res;
+
+            if (!runBench(params, fileName, binary, frames, res)) {
+                std::cerr << "mapbench: " << size << "x" << size
+                          << " walls " << density << " failed" << std::endl;
+                continue;
+            }
+
+            std::cout << std::fixed
+                      << std::setw(8) << res.size
+                      << std::setw(8) << std::setprecision(2) << res.walls
+                      << std::setw(10) << std::setprecision(1) << res.fileMb
+                      << std::setw(12) << std::setprecision(2) << res.loadMs
+                      << std::setw(12) << std::setprecision(4) << res.frameMs
+                      << std::setw(14) << std::setprecision(0) << res.raysPerSec
+                      << std::setw(12) << std::setprecision(2) << res.cellsPerRay
+                      << std::endl;
+
+            if (csv.is_open()) {
+                csv << res.size << "," << res.walls << "," << res.fileMb << ","
+                    << res.loadMs << "," << res.frameMs << ","
+                    << res.raysPerSec << "," << res.cellsPerRay << "\n";
+            }
+        }
+    }
+
+    return 0;
+}
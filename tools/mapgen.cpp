@@ -0,0 +1,133 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+// mapgen: writes a procedural world map in text (world.ini) or binary format
+//
+// Usage: mapgen [options] -o <file>
+//   --size N         rows = cols = N (64 ... 16384)
+//   --rows N         number of rows
+//   --cols N         number of columns
+//   --walls D        wall density (0..1)
+//   --transp R       transparent panel ratio (0..1)
+//   --open R         open area ratio (0..1)
+//   --heights R      ratio of walls with an upper texture (0..1)
+//   --sky R          ratio of empty cells showing the sky (0..1)
+//   --textures N     number of texture keys (1..254)
+//   --seed S         random seed
+//   --format F       'text' (default) or 'bin'
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "MapGenerator.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string.h>
+#include <stdlib.h>
+
+
+/* -------------------------------------------------------------------------- */
+
+static void usage()
+{
+    std::cerr <<
+        "Usage: mapgen [--size N | --rows N --cols N] [--walls D] [--transp R]\n"
+        "              [--open R] [--heights R] [--sky R] [--textures N]\n"
+        "              [--seed S] [--format text|bin] -o <file>\n";
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+int main(int argc, char* argv[])
+{
+    MapGenerator::Params params;
+    std::string fileName;
+    bool binary = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+
+        const char* value = argv[++i];
+
+        if (arg == "--size") {
+            params.rows = params.cols = uint32_t(atoi(value));
+        }
+        else if (arg == "--rows") {
+            params.rows = uint32_t(atoi(value));
+        }
+        else if (arg == "--cols") {
+            params.cols = uint32_t(atoi(value));
+        }
+        else if (arg == "--walls") {
+            params.wallDensity = atof(value);
+        }
+        else if (arg == "--transp") {
+            params.transpRatio = atof(value);
+        }
+        else if (arg == "--open") {
+            params.openAreaRatio = atof(value);
+        }
+        else if (arg == "--heights") {
+            params.wallHeightRatio = atof(value);
+        }
+        else if (arg == "--sky") {
+            params.skyRatio = atof(value);
+        }
+        else if (arg == "--textures") {
+            params.textureCount = atoi(value);
+        }
+        else if (arg == "--seed") {
+            params.seed = uint32_t(strtoul(value, nullptr, 0));
+        }
+        else if (arg == "--format") {
+            binary = strcmp(value, "bin") == 0;
+        }
+        else if (arg == "-o") {
+            fileName = value;
+        }
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    if (fileName.empty() || params.rows < 2 || params.cols < 2) {
+        usage();
+        return 1;
+    }
+
+    std::ofstream os(fileName, std::ios::out | std::ios::binary);
+
+    if (!os.is_open()) {
+        std::cerr << "mapgen: cannot create " << fileName << std::endl;
+        return 1;
+    }
+
+    MapGenerator generator(params);
+
+    const bool ok = binary ?
+        generator.writeBinary(os) :
+        generator.writeText(os);
+
+    if (!ok) {
+        std::cerr << "mapgen: error writing " << fileName << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
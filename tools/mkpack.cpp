@@ -0,0 +1,162 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+// mkpack: builds the asset pack (see AssetPack) of a resource directory,
+// made of the compiled map and of the textures it refers to, converted
+// to 32 bit pixels at the size used by the renderer
+//
+// Usage: mkpack [options] -o <file>
+//   --res DIR        resource directory (default: res)
+//   --map FILE       map file, relative to DIR (default: world.ini)
+//   --cell N         size of the wall textures (default: 512)
+//   --sky NAME       sky image name, without extension (default: clouds)
+//   --sky-size WxH   size of the sky texture (default: 512x512)
+//   --levels N       mip levels of each texture, 0 for all (default: 1)
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "AssetPack.h"
+#include "WorldMap.h"
+
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/* -------------------------------------------------------------------------- */
+
+static void usage()
+{
+    std::cerr <<
+        "Usage: mkpack [--res DIR] [--map FILE] [--cell N] [--sky NAME]\n"
+        "              [--sky-size WxH] [--levels N] -o <file>\n";
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+int main(int argc, char* argv[])
+{
+    std::string resDir = "res";
+    std::string mapFile = "world.ini";
+    std::string skyName = "clouds";
+    std::string fileName;
+    int cellSize = 512;
+    int skyDx = 512;
+    int skyDy = 512;
+    int levels = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+
+        const char* value = argv[++i];
+
+        if (arg == "--res") {
+            resDir = value;
+        }
+        else if (arg == "--map") {
+            mapFile = value;
+        }
+        else if (arg == "--cell") {
+            cellSize = atoi(value);
+        }
+        else if (arg == "--sky") {
+            skyName = value;
+        }
+        else if (arg == "--sky-size") {
+            if (sscanf(value, "%dx%d", &skyDx, &skyDy) != 2) {
+                usage();
+                return 1;
+            }
+        }
+        else if (arg == "--levels") {
+            levels = atoi(value);
+        }
+        else if (arg == "-o") {
+            fileName = value;
+        }
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    if (fileName.empty() || cellSize < 1 || skyDx < 1 || skyDy < 1 || levels < 0) {
+        usage();
+        return 1;
+    }
+
+    if (levels == 0) {
+        levels = AssetPack::MAX_LEVELS;
+    }
+
+    WorldMap world;
+
+    if (!world.load(resDir + "/" + mapFile)) {
+        std::cerr << "mkpack: " << resDir << "/" << mapFile << ": "
+            << world.getLastError() << std::endl;
+        return 1;
+    }
+
+    std::map<int, std::unique_ptr<BitmapBuffer>> images;
+
+    auto loadImage = [&](int panelKey, const std::string& name, int dx, int dy) {
+        const std::string imageFile = resDir + "/" + name + ".bmp";
+        std::unique_ptr<BitmapBuffer> image(new BitmapBuffer);
+
+        if (!image->load(imageFile, dx, dy)) {
+            std::cerr << "mkpack: cannot load " << imageFile << std::endl;
+            return false;
+        }
+
+        images[panelKey] = std::move(image);
+
+        return true;
+    };
+
+    for (const auto & item : world.getTextureList()) {
+        if (!loadImage(
+            int(strtol(item.first.c_str(), nullptr, 16)),
+            item.second,
+            cellSize, cellSize))
+        {
+            return 1;
+        }
+    }
+
+    if (!skyName.empty() && !loadImage(0xff, skyName, skyDx, skyDy)) {
+        return 1;
+    }
+
+    std::map<int, const BitmapBuffer*> textures;
+
+    for (const auto & item : images) {
+        textures[item.first] = item.second.get();
+    }
+
+    std::string error;
+
+    if (!AssetPack::write(fileName, world, textures, levels, error)) {
+        std::cerr << "mkpack: " << error << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
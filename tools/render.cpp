@@ -0,0 +1,317 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+// render: renders frames of a map without a display, writing them to BMP
+// files or to a raw video stream (a file, "-" or a "|command" pipe)
+//
+// Usage: render [options] -o <file>
+//   --res DIR        resource directory (default: res); DIR/world.pak is
+//                    used when present
+//   --map FILE       map file, relative to DIR (default: world.ini)
+//   --size WxH       projection resolution (default: 512x512)
+//   --cell N         cell and wall texture size (default: 512)
+//   --pos C,R        camera cell column and row (default: 4,4)
+//   --alpha A        camera direction, in projection columns (default: 0)
+//   --turn D         camera rotation per frame, in columns (default: 0)
+//   --frames N       number of frames (default: 1)
+//   --format F       'bmp' (default: "%d" in the file name is replaced by
+//                    the frame number) or 'raw' (BGRX frames)
+//   --buffers N      write the frames on a thread of their own, through N
+//                    (2 or 3) buffers, while the next ones are rendered
+//                    (default: 0, the frames are written by the renderer)
+//   --target MS      scale the projection resolution to hold a frame time
+//                    target (frames are written at the resolution they are
+//                    rendered at, unless --scale is given)
+//   --scale WxH      scale the frames to WxH pixels before writing them
+//   --filter F       'nearest' (default) or 'bilinear' scaling
+//   --profile FILE   write the timings of the stages of each frame to a
+//                    CSV file (at most the last 4096 frames)
+//   --overlay        draw the frame rate and the stage timings over the
+//                    frames
+//   --trace FILE     write a Chrome trace of the loading and of the frames
+//                    (at most 32768 slices per thread) to FILE, to be
+//                    opened with Perfetto
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "AsyncFrameSink.h"
+#include "FrameProfiler.h"
+#include "FrameSink.h"
+#include "RaycastEngine.h"
+#include "ResolutionScaler.h"
+#include "SceneLoader.h"
+#include "TraceLog.h"
+#include "Upscaler.h"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/* -------------------------------------------------------------------------- */
+
+static void usage()
+{
+    std::cerr <<
+        "Usage: render [--res DIR] [--map FILE] [--size WxH] [--cell N]\n"
+        "              [--pos C,R] [--alpha A] [--turn D] [--frames N]\n"
+        "              [--format bmp|raw] [--buffers N] [--target MS]\n"
+        "              [--scale WxH] [--filter nearest|bilinear]\n"
+        "              [--profile FILE] [--overlay] [--trace FILE]\n"
+        "              -o <file>\n";
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+int main(int argc, char* argv[])
+{
+    std::string resDir = "res";
+    std::string mapFile = "world.ini";
+    std::string fileName;
+    int xRes = 512;
+    int yRes = 512;
+    int cellSize = 512;
+    int col = 4;
+    int row = 4;
+    int alpha = 0;
+    int turn = 0;
+    int frames = 1;
+    int buffers = 0;
+    double target = 0;
+    int xScale = 0;
+    int yScale = 0;
+    Upscaler::Filter filter = Upscaler::Filter::NEAREST;
+    FileFrameSink::Format format = FileFrameSink::Format::BMP;
+    std::string profileFile;
+    std::string traceFile;
+    bool overlay = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+
+        if (arg == "--overlay") {
+            overlay = true;
+            continue;
+        }
+
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+
+        const char* value = argv[++i];
+        bool ok = true;
+
+        if (arg == "--res") {
+            resDir = value;
+        }
+        else if (arg == "--map") {
+            mapFile = value;
+        }
+        else if (arg == "--size") {
+            ok = sscanf(value, "%dx%d", &xRes, &yRes) == 2;
+        }
+        else if (arg == "--cell") {
+            cellSize = atoi(value);
+        }
+        else if (arg == "--pos") {
+            ok = sscanf(value, "%d,%d", &col, &row) == 2;
+        }
+        else if (arg == "--alpha") {
+            alpha = atoi(value);
+        }
+        else if (arg == "--turn") {
+            turn = atoi(value);
+        }
+        else if (arg == "--frames") {
+            frames = atoi(value);
+        }
+        else if (arg == "--format") {
+            ok = strcmp(value, "bmp") == 0 || strcmp(value, "raw") == 0;
+            format = strcmp(value, "raw") == 0 ?
+                FileFrameSink::Format::RAW :
+                FileFrameSink::Format::BMP;
+        }
+        else if (arg == "--buffers") {
+            buffers = atoi(value);
+            ok = buffers == 0 || (buffers >= AsyncFrameSink::MIN_BUFFERS &&
+                buffers <= AsyncFrameSink::MAX_BUFFERS);
+        }
+        else if (arg == "--target") {
+            target = atof(value);
+            ok = target > 0;
+        }
+        else if (arg == "--scale") {
+            ok = sscanf(value, "%dx%d", &xScale, &yScale) == 2 &&
+                xScale > 0 && yScale > 0;
+        }
+        else if (arg == "--filter") {
+            ok = strcmp(value, "nearest") == 0 || strcmp(value, "bilinear") == 0;
+            filter = strcmp(value, "bilinear") == 0 ?
+                Upscaler::Filter::BILINEAR :
+                Upscaler::Filter::NEAREST;
+        }
+        else if (arg == "--profile") {
+            profileFile = value;
+        }
+        else if (arg == "--trace") {
+            traceFile = value;
+        }
+        else if (arg == "-o") {
+            fileName = value;
+        }
+        else {
+            ok = false;
+        }
+
+        if (!ok) {
+            usage();
+            return 1;
+        }
+    }
+
+    if (fileName.empty() || xRes < 8 || yRes < 8 || cellSize < 1 || frames < 0) {
+        usage();
+        return 1;
+    }
+
+    // Loading is traced as well
+    if (!traceFile.empty()) {
+        TraceLog::shared().setThreadName("render");
+        TraceLog::shared().setEnabled(true);
+    }
+
+    // Textures come from the pack, if any, or from the BMP files
+    SceneLoader scene;
+
+    if (!scene.load(resDir, mapFile, cellSize, xRes, yRes)) {
+        std::cerr << "render: " << scene.getLastError() << std::endl;
+        return 1;
+    }
+
+    for (const auto & file : scene.getFailedFiles()) {
+        std::cerr << "render: cannot load " << file << std::endl;
+    }
+
+    WorldMap& world = scene.world();
+
+    Player camera(0, 0, 60, xRes, yRes);
+
+    camera.setPos(std::make_pair(double(cellSize * col), double(cellSize * row)));
+    camera.setAlpha(alpha);
+
+    RaycastEngine engine(camera, 250000);
+    FrameProfiler profiler(4096);
+
+    if (overlay || !profileFile.empty()) {
+        profiler.setEnabled(true);
+        profiler.setOverlayVisible(overlay);
+        engine.setProfiler(&profiler);
+    }
+    FileFrameSink sink(fileName, format);
+
+    if (!sink.isOpen()) {
+        std::cerr << "render: cannot open " << fileName << std::endl;
+        return 1;
+    }
+
+    // Frames are scaled (if --scale is given) by the presenter thread
+    ScalingFrameSink scalingSink(sink);
+    std::unique_ptr<AsyncFrameSink> presenter;
+
+    scalingSink.setOutputSize(xScale, yScale, filter);
+
+    if (buffers) {
+        presenter.reset(new AsyncFrameSink(scalingSink, buffers));
+    }
+
+    std::unique_ptr<ResolutionScaler> resolution;
+
+    if (target > 0) {
+        resolution.reset(new ResolutionScaler(xRes, yRes, target));
+        resolution->prepare(engine.player());
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+
+    for (int frame = 0; frame < frames; ++frame) {
+        const auto frameBegin = std::chrono::steady_clock::now();
+
+        if (presenter) {
+            engine.renderScene(world, *presenter);
+        }
+        else {
+            engine.renderScene(world, scalingSink);
+        }
+
+        if (resolution && resolution->update(std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - frameBegin).count()))
+        {
+            resolution->applyTo(engine.player());
+        }
+
+        if (presenter ? presenter->hasFailed() : !sink.isOpen()) {
+            break;
+        }
+
+        engine.player().rotate(turn);
+    }
+
+    if (presenter) {
+        presenter->flush();
+    }
+
+    if (!sink.isOpen()) {
+        std::cerr << "render: error writing " << fileName << std::endl;
+        return 1;
+    }
+
+    const double ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - begin).count();
+
+    std::cerr << "render: " << frames << " frames, "
+        << (frames ? ms / frames : 0.0) << " ms/frame" << std::endl;
+
+    if (!profileFile.empty() && !profiler.writeCsv(profileFile)) {
+        std::cerr << "render: cannot write " << profileFile << std::endl;
+        return 1;
+    }
+
+    if (!traceFile.empty()) {
+        TraceLog& trace = TraceLog::shared();
+
+        trace.setEnabled(false);
+
+        if (!trace.write(traceFile)) {
+            std::cerr << "render: cannot write " << traceFile << std::endl;
+            return 1;
+        }
+
+        if (trace.getDroppedCount()) {
+            std::cerr << "render: " << trace.getDroppedCount()
+                << " trace events dropped" << std::endl;
+        }
+    }
+
+    if (resolution) {
+        std::cerr << "render: " << resolution->getChangeCount()
+            << " resolution changes, last " << resolution->getXProjRes() << "x"
+            << resolution->getYProjRes() << " at " << resolution->getAverage()
+            << " ms/frame" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,663 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+// tknbench: generates synthetic text inputs in memory and runs them through
+// each miptknzr front end (stream tokenizer, token list builder, arena
+// builder, buffer tokenizer and chunk tokenizer) and through WorldMap::load,
+// reporting throughput, allocations per token and peak RSS.
+//
+// Inputs:
+//   lines      long lines of identifiers, numbers and atoms
+//   comments   single-line and multi-line comments around a few tokens
+//   map        a world map text file (see MapGenerator)
+//   strings    lines of escape-heavy string literals
+//
+// Map loading reports map cells as tokens. Each benchmark is run several
+// times and the fastest run is reported; the peak RSS is the process high
+// water mark during the benchmark (Linux only).
+//
+// Usage: tknbench [options]
+//   --inputs L       comma separated inputs (default lines,comments,map,strings)
+//   --mb N           approximate size of the synthetic inputs in MB (default 16)
+//   --map N          rows = cols of the map input (default 1024)
+//   --line N         length of a long line in KB (default 64)
+//   --runs N         runs per benchmark (default 3)
+//   --chunk N        chunk tokenizer chunk size in KB (default 64)
+//   --dir D          directory of the map file (default /tmp)
+//   --csv F          also write the results to a CSV file
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "MapGenerator.h"
+#include "../WorldMap.h"
+
+#include "mip_chunk_tknzr.h"
+#include "mip_esc_cnvrtr.h"
+#include "mip_tknlst_bldr.h"
+#include "mip_tknzr_bldr.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+
+/* -------------------------------------------------------------------------- */
+
+// Every allocation of the process goes through these, so that allocations
+// made by a benchmark can be counted
+
+static std::atomic<uint64_t> s_allocCount{ 0 };
+
+void* operator new(size_t size)
+{
+    ++s_allocCount;
+
+    if (void* p = malloc(size ? size : 1)) {
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsedMs(Clock::time_point since)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+// Reset the process peak RSS, so that the next peakRssMb() reports the
+// high water mark from now on (Linux 4.0 or later)
+static void resetPeakRss()
+{
+#ifdef __GLIBC__
+    // give back the memory freed by the previous benchmark first
+    malloc_trim(0);
+#endif
+
+    std::ofstream os("/proc/self/clear_refs");
+
+    if (os.is_open()) {
+        os << "5";
+    }
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+static double peakRssMb()
+{
+    std::ifstream is("/proc/self/status");
+    std::string line;
+
+    while (std::getline(is, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return atof(line.c_str() + 6) / 1024.0;
+        }
+    }
+
+#ifdef __linux__
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        return double(usage.ru_maxrss) / 1024.0;
+    }
+#endif
+
+    return 0;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+template <class T>
+static std::vector<T> parseList(const std::string& list)
+{
+    std::vector<T> values;
+    std::stringstream ss(list);
+    std::string item;
+
+    while (std::getline(ss, item, ',')) {
+        std::stringstream is(item);
+        T value;
+
+        if (is >> value) {
+            values.push_back(value);
+        }
+    }
+
+    return values;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+// Same definitions used by WorldMap::load
+static void defineTokens(mip::tknzr_bldr_t& bldr)
+{
+    bldr.def_atom(_T("{"));
+    bldr.def_atom(_T("}"));
+    bldr.def_atom(_T(","));
+
+    bldr.def_sl_comment(_T("//"));
+    bldr.def_sl_comment(_T("#"));
+    bldr.def_blank(_T(" "));
+    bldr.def_blank(_T("\r"));
+    bldr.def_blank(_T("\t"));
+
+    bldr.def_eol(mip::base_tknzr_t::eol_t::LF);
+
+    bldr.def_string(_T('\"'), std::make_shared<mip::esc_cnvrtr_t>(_T('\\')));
+
+    bldr.def_ml_comment(_T("/*"), _T("*/"));
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+static std::string makeLongLines(size_t bytes, size_t lineBytes, std::mt19937& rnd)
+{
+    static const char* const words[] = {
+        "texture", "wall_01", "ceiling", "{", "}", ",", "0x1f2e3d", "4096",
+        "floor_texture_name", "a", "sky", "panel", "x", "12345678"
+    };
+
+    std::string text;
+    size_t lineBegin = 0;
+
+    text.reserve(bytes + lineBytes);
+
+    while (text.size() < bytes) {
+        text += words[rnd() % (sizeof(words) / sizeof(words[0]))];
+        text += (rnd() % 4) ? " " : "\t";
+
+        if (text.size() - lineBegin >= lineBytes) {
+            text += "\n";
+            lineBegin = text.size();
+        }
+    }
+
+    text += "\n";
+
+    return text;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+static std::string makeComments(size_t bytes, std::mt19937& rnd)
+{
+    std::string text;
+
+    text.reserve(bytes + 256);
+
+    while (text.size() < bytes) {
+        switch (rnd() % 4) {
+        case 0:
+            text += "// a single line comment about the next texture\n";
+            break;
+
+        case 1:
+            text += "# shell style comment, some more text here\n";
+            break;
+
+        case 2:
+            text += "/* a multi-line comment\n"
+                    " * spanning a few lines of text\n"
+                    " * before the end marker */\n";
+            break;
+
+        default:
+            text += "texture { 01, 02 } /* inline */ wall // trailing\n";
+            break;
+        }
+    }
+
+    return text;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+static std::string makeStrings(size_t bytes, std::mt19937& rnd)
+{
+    static const char* const parts[] = {
+        "plain", "\\\"", "\\\\", "\\n", "\\t", "\\x41", "\\101", " ", "path"
+    };
+
+    std::string text;
+
+    text.reserve(bytes + 256);
+
+    while (text.size() < bytes) {
+        for (int s = 0; s < 8; ++s) {
+            text += s ? ", \"" : "\"";
+
+            for (int i = 0; i < 12; ++i) {
+                text += parts[rnd() % (sizeof(parts) / sizeof(parts[0]))];
+            }
+
+            text += "\"";
+        }
+
+        text += "\n";
+    }
+
+    return text;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+static std::string makeMap(uint32_t size)
+{
+    MapGenerator::Params params;
+
+    params.rows = params.cols = size;
+
+    std::ostringstream os;
+    MapGenerator(params).writeText(os);
+
+    return os.str();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+struct BenchResult {
+    double ms = 0;
+    uint64_t tokens = 0;
+    uint64_t allocs = 0;
+    double peakMb = 0;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+// Run a benchmark function (which returns the number of tokens, or 0 in
+// case of failure) and keep the fastest of the runs
+static bool runBench(
+    int runs,
+    const std::function<uint64_t()>& bench,
+    BenchResult& res)
+{
+    for (int run = 0; run < runs; ++run) {
+        resetPeakRss();
+
+        const uint64_t allocs = s_allocCount;
+        const auto t0 = Clock::now();
+        const uint64_t tokens = bench();
+        const double ms = elapsedMs(t0);
+
+        if (!tokens) {
+            return false;
+        }
+
+        if (run == 0 || ms < res.ms) {
+            res.ms = ms;
+        }
+
+        res.tokens = tokens;
+        res.allocs = s_allocCount - allocs;
+        res.peakMb = peakRssMb();
+    }
+
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+static uint64_t benchTknzr(const std::string& text)
+{
+    mip::tknzr_bldr_t bldr;
+    defineTokens(bldr);
+
+    auto tknzr = bldr.build();
+    std::istringstream is(text);
+    uint64_t tokens = 0;
+
+    while (!tknzr->eos(is)) {
+        auto tkn = tknzr->next(is);
+
+        if (!tkn) {
+            return 0;
+        }
+
+        ++tokens;
+    }
+
+    return tokens;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+static uint64_t benchTknlst(const std::string& text)
+{
+    mip::tknzr_bldr_t bldr;
+    defineTokens(bldr);
+
+    mip::tknlst_bldr_t lstBldr(std::move(bldr));
+    mip::tknlist_t nonblnks, blnks;
+    std::istringstream is(text);
+
+    if (!lstBldr.build(is, nonblnks, blnks)) {
+        return 0;
+    }
+
+    return nonblnks.size() + blnks.size();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+static uint64_t benchArena(const std::string& text)
+{
+    mip::tknzr_bldr_t bldr;
+    defineTokens(bldr);
+
+    mip::tknlst_bldr_t lstBldr(std::move(bldr));
+    mip::tkn_arena_t nonblnks, blnks;
+
+    if (!lstBldr.build(mip::string_view_t(text), nonblnks, blnks)) {
+        return 0;
+    }
+
+    return nonblnks.size() + blnks.size();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+static uint64_t benchBuf(const std::string& text)
+{
+    mip::tknzr_bldr_t bldr;
+    defineTokens(bldr);
+
+    auto tknzr = bldr.build_buf();
+    mip::token_view_t tkn;
+    uint64_t tokens = 0;
+
+    tknzr->reset(text);
+
+    while (tknzr->next(tkn)) {
+        ++tokens;
+    }
+
+    return tokens;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+static uint64_t benchChunk(const std::string& text, size_t chunkBytes)
+{
+    mip::tknzr_bldr_t bldr;
+    defineTokens(bldr);
+
+    auto tknzr = bldr.build_chunk();
+    uint64_t tokens = 0;
+
+    const auto handler = [&tokens](const mip::token_view_t&) {
+        ++tokens;
+    };
+
+    for (size_t pos = 0; pos < text.size(); pos += chunkBytes) {
+        if (!tknzr->push(mip::string_view_t(text).substr(pos, chunkBytes), handler)) {
+            return 0;
+        }
+    }
+
+    return tknzr->finish(handler) ? tokens : 0;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+static uint64_t benchLoad(const std::string& fileName)
+{
+    WorldMap wMap;
+
+    if (!wMap.load(fileName)) {
+        std::cerr << fileName << ": " << wMap.getLastError() << std::endl;
+        return 0;
+    }
+
+    return uint64_t(wMap.getRowCount()) * uint64_t(wMap.getColCount());
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+static void usage()
+{
+    std::cerr <<
+        "Usage: tknbench [--inputs L] [--mb N] [--map N] [--line N]\n"
+        "                [--runs N] [--chunk N] [--dir D] [--csv F]\n";
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> inputs{ "lines", "comments", "map", "strings" };
+    size_t mb = 16;
+    uint32_t mapSize = 1024;
+    size_t lineKb = 64;
+    size_t chunkKb = 64;
+    int runs = 3;
+    std::string dir = "/tmp";
+    std::string csvFile;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+
+        const std::string value = argv[++i];
+        bool ok = true;
+
+        if (arg == "--inputs") {
+            inputs = parseList<std::string>(value);
+        }
+        else if (arg == "--mb") {
+            mb = size_t(atoi(value.c_str()));
+        }
+        else if (arg == "--map") {
+            mapSize = uint32_t(atoi(value.c_str()));
+        }
+        else if (arg == "--line") {
+            lineKb = size_t(atoi(value.c_str()));
+        }
+        else if (arg == "--runs") {
+            runs = atoi(value.c_str());
+        }
+        else if (arg == "--chunk") {
+            chunkKb = size_t(atoi(value.c_str()));
+        }
+        else if (arg == "--dir") {
+            dir = value;
+        }
+        else if (arg == "--csv") {
+            csvFile = value;
+        }
+        else {
+            ok = false;
+        }
+
+        if (!ok) {
+            usage();
+            return 1;
+        }
+    }
+
+    if (runs < 1) {
+        runs = 1;
+    }
+
+    if (mb < 1) {
+        mb = 1;
+    }
+
+    if (lineKb < 1) {
+        lineKb = 1;
+    }
+
+    if (chunkKb < 1) {
+        chunkKb = 1;
+    }
+
+    std::ofstream csv;
+
+    if (!csvFile.empty()) {
+        csv.open(csvFile);
+        csv << "input,bench,size_mb,ms,mb_per_sec,tokens,tokens_per_sec,"
+               "allocs_per_token,peak_rss_mb\n";
+    }
+
+    std::cout << std::setw(10) << "input"
+              << std::setw(8) << "bench"
+              << std::setw(9) << "size(MB)"
+              << std::setw(11) << "time(ms)"
+              << std::setw(9) << "MB/s"
+              << std::setw(12) << "tokens"
+              << std::setw(12) << "Mtokens/s"
+              << std::setw(11) << "alloc/tkn"
+              << std::setw(10) << "RSS(MB)"
+              << std::endl;
+
+    std::mt19937 rnd(1);
+    bool ok = true;
+
+    for (const auto& input : inputs) {
+        std::string text;
+
+        if (input == "lines") {
+            text = makeLongLines(mb << 20, lineKb << 10, rnd);
+        }
+        else if (input == "comments") {
+            text = makeComments(mb << 20, rnd);
+        }
+        else if (input == "map") {
+            text = makeMap(mapSize);
+        }
+        else if (input == "strings") {
+            text = makeStrings(mb << 20, rnd);
+        }
+        else {
+            std::cerr << "tknbench: unknown input " << input << std::endl;
+            return 1;
+        }
+
+        std::vector<std::pair<std::string, std::function<uint64_t()>>> benches{
+            { "tknzr", [&text]() { return benchTknzr(text); } },
+            { "tknlst", [&text]() { return benchTknlst(text); } },
+            { "arena", [&text]() { return benchArena(text); } },
+            { "buf", [&text]() { return benchBuf(text); } },
+            { "chunk", [&text, chunkKb]() { return benchChunk(text, chunkKb << 10); } }
+        };
+
+        const std::string fileName = dir + "/tknbench_map.ini";
+
+        if (input == "map") {
+            std::ofstream os(fileName, std::ios::out | std::ios::binary);
+
+            if (!os.write(text.data(), std::streamsize(text.size()))) {
+                std::cerr << "tknbench: cannot write " << fileName << std::endl;
+                return 1;
+            }
+
+            benches.push_back({ "load", [&fileName]() { return benchLoad(fileName); } });
+        }
+
+        const double sizeMb = double(text.size()) / (1024.0 * 1024.0);
+
+        for (const auto& bench : benches) {
+            BenchResult res;
+
+            if (!runBench(runs, bench.second, res)) {
+                std::cerr << "tknbench: " << input << " " << bench.first
+                          << " failed" << std::endl;
+                ok = false;
+                continue;
+            }
+
+            const double secs = res.ms / 1000.0;
+            const double mbPerSec = secs > 0 ? sizeMb / secs : 0;
+            const double tknPerSec = secs > 0 ? double(res.tokens) / secs : 0;
+            const double allocsPerTkn = double(res.allocs) / double(res.tokens);
+
+            std::cout << std::fixed
+                      << std::setw(10) << input
+                      << std::setw(8) << bench.first
+                      << std::setw(9) << std::setprecision(1) << sizeMb
+                      << std::setw(11) << std::setprecision(2) << res.ms
+                      << std::setw(9) << std::setprecision(1) << mbPerSec
+                      << std::setw(12) << res.tokens
+                      << std::setw(12) << std::setprecision(2) << tknPerSec / 1e6
+                      << std::setw(11) << std::setprecision(3) << allocsPerTkn
+                      << std::setw(10) << std::setprecision(1) << res.peakMb
+                      << std::endl;
+
+            if (csv.is_open()) {
+                csv << input << "," << bench.first << "," << sizeMb << ","
+                    << res.ms << "," << mbPerSec << "," << res.tokens << ","
+                    << tknPerSec << "," << allocsPerTkn << "," << res.peakMb
+                    << "\n";
+            }
+        }
+
+        if (input == "map") {
+            remove(fileName.c_str());
+        }
+    }
+
+    return ok ? 0 : 1;
+}
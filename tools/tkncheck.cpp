@@ -0,0 +1,254 @@
+// This file is part of the WinRayCast Application (a 3D Engine Demo).
+// Copyright (C) 2005 - 2018
+// Antonino Calderone (antonino.calderone@gmail.com)
+// All rights reserved.  
+// Licensed under the MIT License. 
+// See COPYING file in the project root for full license information.
+
+
+/* -------------------------------------------------------------------------- */
+
+// tkncheck: checks the miptknzr chunk tokenizer against the buffer
+// tokenizer. Texts with comments, strings and long multi-line comments are
+// pushed in chunks of several sizes (down to one byte at a time), and the
+// tokens produced must be the same of a buffer tokenizer run over the whole
+// text (type, value, line and offset). Then a long multi-line comment is
+// pushed one byte at a time at two sizes, and the time must grow about
+// linearly with the size: each byte of an open comment is to be scanned
+// once, whatever the chunks are.
+//
+// Usage: tkncheck
+//
+// The exit code is 0 if all the checks pass.
+
+
+/* -------------------------------------------------------------------------- */
+
+#include "mip_chunk_tknzr.h"
+#include "mip_esc_cnvrtr.h"
+#include "mip_tknzr_bldr.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+
+
+/* -------------------------------------------------------------------------- */
+
+using Clock = std::chrono::steady_clock;
+
+// A token, as compared
+struct Token {
+    mip::token_t::tcl_t type;
+    std::string value;
+    size_t line;
+    size_t offset;
+
+    bool operator==(const Token& other) const {
+        return type == other.type && value == other.value &&
+            line == other.line && offset == other.offset;
+    }
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+// Same definitions used by WorldMap::load
+static void defineTokens(mip::tknzr_bldr_t& bldr)
+{
+    bldr.def_atom(_T("{"));
+    bldr.def_atom(_T("}"));
+    bldr.def_atom(_T(","));
+
+    bldr.def_sl_comment(_T("//"));
+    bldr.def_sl_comment(_T("#"));
+    bldr.def_blank(_T(" "));
+    bldr.def_blank(_T("\r"));
+    bldr.def_blank(_T("\t"));
+
+    bldr.def_eol(mip::base_tknzr_t::eol_t::LF);
+
+    bldr.def_string(_T('\"'), std::make_shared<mip::esc_cnvrtr_t>(_T('\\')));
+
+    bldr.def_ml_comment(_T("/*"), _T("*/"));
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+static Token makeToken(const mip::token_view_t& tkn)
+{
+    const auto value = tkn.value();
+
+    return Token{
+        tkn.type(), std::string(value.data(), value.size()), tkn.line(), tkn.offset() };
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+// A multi-line comment of about bytes characters, between two tokens
+static std::string makeLongComment(size_t bytes)
+{
+    std::string text = "texture { 01 } /* a long comment\n";
+
+    while (text.size() < bytes) {
+        text += " * one more line of a comment which does not end here\n";
+    }
+
+    text += " * the end */ wall, \"a \\\"string\\\"\" // trailing\nsky\n";
+
+    return text;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+static std::vector<Token> runBuf(const std::string& text)
+{
+    mip::tknzr_bldr_t bldr;
+    defineTokens(bldr);
+
+    auto tknzr = bldr.build_buf();
+    mip::token_view_t tkn;
+    std::vector<Token> tokens;
+
+    tknzr->reset(text);
+
+    while (tknzr->next(tkn)) {
+        tokens.push_back(makeToken(tkn));
+    }
+
+    return tokens;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+static bool runChunk(
+    const std::string& text, size_t chunkBytes, std::vector<Token>& tokens)
+{
+    mip::tknzr_bldr_t bldr;
+    defineTokens(bldr);
+
+    auto tknzr = bldr.build_chunk();
+
+    const auto handler = [&tokens](const mip::token_view_t& tkn) {
+        tokens.push_back(makeToken(tkn));
+    };
+
+    for (size_t pos = 0; pos < text.size(); pos += chunkBytes) {
+        if (!tknzr->push(mip::string_view_t(text).substr(pos, chunkBytes), handler)) {
+            return false;
+        }
+    }
+
+    return tknzr->finish(handler);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+// Return the time of the fastest of a few runs pushing text one byte at
+// a time, in milliseconds
+static double timeBytewise(const std::string& text)
+{
+    double best = 0;
+
+    for (int run = 0; run < 3; ++run) {
+        std::vector<Token> tokens;
+        const auto begin = Clock::now();
+
+        runChunk(text, 1, tokens);
+
+        const double ms = std::chrono::duration<double, std::milli>(
+            Clock::now() - begin).count();
+
+        best = run ? std::min(best, ms) : ms;
+    }
+
+    return best;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+static bool checkSame(const char* name, const std::string& text)
+{
+    const std::vector<Token> expected = runBuf(text);
+    bool ok = true;
+
+    for (size_t chunkBytes : { size_t(1), size_t(2), size_t(7), size_t(64), text.size() }) {
+        std::vector<Token> tokens;
+
+        if (!runChunk(text, chunkBytes, tokens)) {
+            std::cerr << "tkncheck: " << name << ", chunks of " << chunkBytes
+                << ": tokenizer error" << std::endl;
+            ok = false;
+            continue;
+        }
+
+        if (tokens != expected) {
+            size_t i = 0;
+
+            while (i < tokens.size() && i < expected.size() && tokens[i] == expected[i]) {
+                ++i;
+            }
+
+            std::cerr << "tkncheck: " << name << ", chunks of " << chunkBytes
+                << ": token " << i << " differs" << std::endl;
+            ok = false;
+        }
+    }
+
+    std::cout << "tkncheck: " << name << ": " << expected.size() << " tokens, "
+        << (ok ? "same" : "different") << std::endl;
+
+    return ok;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+int main(int argc, char**)
+{
+    if (argc > 1) {
+        std::cerr << "Usage: tkncheck" << std::endl;
+        return 1;
+    }
+
+    bool ok = true;
+
+    ok = checkSame("mixed",
+        "texture { 01, 02 } /* inline */ wall // trailing\n"
+        "/* a multi-line comment\n * spanning a few lines\n */ sky\n"
+        "\"a \\\"string\\\"\" # shell comment\n"
+        "/* unterminated comment\n * up to the end") && ok;
+
+    ok = checkSame("long comment", makeLongComment(64 * 1024)) && ok;
+
+    // Scanning the whole open comment at every line would make the time
+    // grow with the square of the size (16 times, here)
+    const size_t small = 512 * 1024;
+    const double smallMs = timeBytewise(makeLongComment(small));
+    const double largeMs = timeBytewise(makeLongComment(4 * small));
+    const double ratio = smallMs > 0 ? largeMs / smallMs : 0;
+
+    char line[128];
+    snprintf(line, sizeof(line),
+        "tkncheck: long comment one byte at a time: %.1f ms, 4x size %.1f ms "
+        "(%.1fx)", smallMs, largeMs, ratio);
+
+    std::cout << line << std::endl;
+
+    if (ratio > 8) {
+        std::cerr << "tkncheck: the time grows faster than the comment size"
+            << std::endl;
+        ok = false;
+    }
+
+    return ok ? 0 : 1;
+}